@@ -0,0 +1,282 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+// tiling-headless: drives the tile pipeline along a camera path on the null
+// render backend. Camera, ChunkManager::Update, loads, uploads and draws all
+// run as in the viewer, without a window, at full speed. The path is either
+// a built-in zoom and pan or a recording made with `tiling --record`.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/null_render_backend.h"
+#include "core/orthographic_camera.h"
+#include "core/timer.h"
+#include "core/tracer.h"
+
+#include "resources/zoom_pan_camera.h"
+
+#include "camera_path.h"
+#include "chunk_manager.h"
+#include "http_server.h"
+#include "replay_report.h"
+#include "tile_layout.h"
+#include "tile_renderer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace fs = std::filesystem;
+
+struct Options {
+    fs::path pack {"assets/pyramid.pack"};
+    // a recorded camera path, the built-in one is used when empty
+    fs::path replay {};
+    // Chrome trace of every tile load, not written when empty
+    fs::path trace {};
+    // fetches tiles from an HTTP server, see serve
+    std::string url {};
+    // serves the pack, or the loose tiles, from a local HTTP server and
+    // fetches them from it
+    bool serve {false};
+    // delays tile reads like remote storage, set by any of the network options
+    std::optional<SimulatedTileSource::Parameters> simulate {};
+    // LODs above this are decoded from finer tiles, -1 for only missing ones
+    int derive_above {-1};
+    // frames the built-in camera path is spread over
+    int frames {600};
+    // how long to keep running after the path for loads to settle
+    double settle_timeout {10.0};
+};
+
+struct Keyframe {
+    double time;
+    glm::vec2 center;
+    float scale;
+};
+
+// zoom into the middle of the image, then pan to the right edge
+static auto BuiltinPath(int frames, float image_size, glm::vec2 view_size) -> CameraPath {
+    const auto center = glm::vec2 {image_size / 2.0f};
+    const auto keys = std::vector<Keyframe> {
+        {0.0, center, 1.0f},
+        {2.0, center, 0.25f},
+        {5.0, {image_size * 0.85f, center.y}, 0.25f}
+    };
+
+    auto path = CameraPath {};
+    const auto step = keys.back().time / frames;
+    for (auto frame = 0; frame < frames; ++frame) {
+        const auto time = frame * step;
+        auto key = keys.back();
+        for (auto i = 1u; i < keys.size(); ++i) {
+            if (time <= keys[i].time) {
+                const auto t = static_cast<float>((time - keys[i - 1].time) / (keys[i].time - keys[i - 1].time));
+                key.center = glm::mix(keys[i - 1].center, keys[i].center, t);
+                key.scale = glm::mix(keys[i - 1].scale, keys[i].scale, t);
+                break;
+            }
+        }
+
+        // the view centre sits at the middle of the camera's frame
+        auto transform = glm::translate(glm::mat4 {1.0f}, glm::vec3 {key.center - view_size / 2.0f * key.scale, 0.0f});
+        transform = glm::scale(transform, glm::vec3 {key.scale, key.scale, 1.0f});
+        path.Record(transform, step);
+    }
+    return path;
+}
+
+static auto PrintUsage() {
+    std::print(stderr,
+        "usage: tiling-headless [options]\n"
+        "  -p, --pack <file>    tile pack, loose tiles under assets/ if missing\n"
+        "  -r, --replay <file>  camera path recorded with tiling --record\n"
+        "  -o, --trace <file>   save a Chrome trace of tile loads\n"
+        "  --url <url>          tile pack URL ending in .pack, or the URL of loose tiles\n"
+        "  -s, --serve          fetch the tiles over HTTP from a local server\n"
+        "  --latency <ms>       delay every tile read like remote storage\n"
+        "  --jitter <ms>        random extra delay of up to this much per read\n"
+        "  --bandwidth <MB/s>   bandwidth shared by all tile reads\n"
+        "  --derive-above <lod> decode coarser LODs from finer tiles even if stored\n"
+        "  -f, --frames <n>     frames along the built-in camera path, default 600\n"
+        "  -t, --timeout <s>    seconds to wait for loads to settle, default 10\n"
+    );
+}
+
+static auto ParseOptions(int argc, char** argv) -> std::optional<Options> {
+    auto options = Options {};
+    auto simulate = [&]() -> SimulatedTileSource::Parameters& {
+        if (!options.simulate) options.simulate.emplace();
+        return options.simulate.value();
+    };
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view {argv[i]};
+        const auto has_value = i + 1 < argc;
+        if ((arg == "-p" || arg == "--pack") && has_value) {
+            options.pack = argv[++i];
+        } else if ((arg == "-r" || arg == "--replay") && has_value) {
+            options.replay = argv[++i];
+        } else if ((arg == "-o" || arg == "--trace") && has_value) {
+            options.trace = argv[++i];
+        } else if (arg == "--url" && has_value) {
+            options.url = argv[++i];
+        } else if (arg == "-s" || arg == "--serve") {
+            options.serve = true;
+        } else if (arg == "--latency" && has_value) {
+            simulate().latency_ms = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--jitter" && has_value) {
+            simulate().jitter_ms = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--bandwidth" && has_value) {
+            simulate().bandwidth_mb = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--derive-above" && has_value) {
+            options.derive_above = std::max(std::atoi(argv[++i]), 0);
+        } else if ((arg == "-f" || arg == "--frames") && has_value) {
+            options.frames = std::max(std::atoi(argv[++i]), 1);
+        } else if ((arg == "-t" || arg == "--timeout") && has_value) {
+            options.settle_timeout = std::max(std::atof(argv[++i]), 0.0);
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+auto main(int argc, char** argv) -> int {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    // same view as the viewer
+    constexpr auto win_width = 1024;
+    constexpr auto win_height = 1024;
+    constexpr auto camera_width = 2048.0f;
+    constexpr auto camera_height = camera_width * win_height / win_width;
+    constexpr auto image_size = 2048.0f;
+
+    if (!options->trace.empty()) {
+        Tracer::Get().SetEnabled(true);
+    }
+
+    const auto has_pack = fs::exists(options->pack);
+    auto url = options->url;
+    // declared before the chunk manager, loads in flight finish before it stops
+    auto server = std::optional<HttpServer> {};
+    if (options->serve) {
+        server.emplace(has_pack ? options->pack.parent_path() : fs::path {tile_layout::kRoot});
+        if (server->Port() == 0) {
+            std::print(stderr, "Could not start the local HTTP server\n");
+            return EXIT_FAILURE;
+        }
+        url = std::format("http://127.0.0.1:{}/{}", server->Port(), has_pack ? options->pack.filename().string() : "");
+    }
+
+    auto backend = NullRenderBackend {};
+    auto chunk_manager = ChunkManager {{
+        .image_dims = {2048, 2048},
+        .window_dims = {win_width, win_height},
+        .lods = 3,
+        .pack = has_pack ? options->pack : "",
+        .url = url,
+        .simulate = options->simulate,
+        .derive_above = options->derive_above
+    }, backend};
+    auto camera = OrthographicCamera {0.0f, camera_width, camera_height, 0.0f, -1.0f, 1.0f};
+    auto renderer = TileRenderer {backend};
+
+    auto path = BuiltinPath(options->frames, image_size, {camera_width, camera_height});
+    if (!options->replay.empty()) {
+        auto recording = CameraPath::Load(options->replay);
+        if (!recording) {
+            std::print(stderr, "{}\n", recording.error());
+            return EXIT_FAILURE;
+        }
+        path = std::move(recording.value());
+    }
+    if (path.Frames() == 0) {
+        std::print(stderr, "The camera path is empty\n");
+        return EXIT_FAILURE;
+    }
+
+    auto controls = ZoomPanCamera {&camera};
+    auto report = ReplayReport {};
+
+    const auto timer = Timer {};
+    auto frame_timer = Timer {};
+    auto frames = std::size_t {0};
+    auto settle_start = 0.0;
+    auto settled = true;
+    for (;; ++frames) {
+        // after the path ends the camera rests on its last frame
+        const auto on_path = frames < path.Frames();
+        const auto& key = path[std::min(frames, path.Frames() - 1)];
+        camera.transform = key.transform;
+        controls.TrackMotion(frames == 0 || !on_path ? 0.0 : key.delta);
+
+        chunk_manager.Update(camera, on_path ? controls.Velocity() : CameraMotion {});
+        renderer.Draw(chunk_manager.GetVisibleTiles(), camera);
+
+        // the settle frames below mostly sleep, they would skew the frame times
+        if (on_path) {
+            report.AddFrame(frame_timer.GetSeconds() * 1000.0, camera.transform, chunk_manager.IsSharp());
+            frame_timer.Reset();
+            continue;
+        }
+        if (settle_start == 0.0) settle_start = timer.GetSeconds();
+        if (chunk_manager.Pending() == 0 && chunk_manager.IsSharp()) break;
+        if (timer.GetSeconds() - settle_start > options->settle_timeout) {
+            std::print(stderr, "Loads did not settle within {}s\n", options->settle_timeout);
+            settled = false;
+            break;
+        }
+        // loads are off-thread, don't spin the main thread while waiting
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const auto elapsed = timer.GetSeconds();
+    const auto stats = backend.GetStats();
+    const auto residency = chunk_manager.Residency();
+    report.Print(residency);
+    std::print(
+        "elapsed         {:.3f} s\n"
+        "uploads         {} ({:.1f} MB)\n"
+        "binds           {}\n"
+        "draw calls      {}\n"
+        "instances       {}\n"
+        "resident        {:.1f} MB in {} chunks\n"
+        "evictions       {}\n",
+        elapsed,
+        stats.uploads, stats.upload_bytes / 1048576.0,
+        stats.binds,
+        stats.draw_calls,
+        stats.instances,
+        residency.resident_bytes / 1048576.0, residency.resident_chunks,
+        residency.evictions
+    );
+    if (server) {
+        std::print("http requests   {}\n", server->Requests());
+    }
+
+    if (!options->trace.empty()) {
+        auto& tracer = Tracer::Get();
+        tracer.SetEnabled(false);
+        if (auto result = tracer.Save(options->trace); !result) {
+            std::print(stderr, "{}\n", result.error());
+            return EXIT_FAILURE;
+        }
+        std::print("trace           '{}', {} events dropped\n", options->trace.string(), tracer.Dropped());
+    }
+
+    // the report is still printed, but a run that didn't settle has failed
+    return settled ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "http_server.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
+#include <fstream>
+
+static constexpr auto kMaxHeaderBytes = std::size_t {64} << 10;
+
+HttpServer::HttpServer(const fs::path& root) : root_(root) {
+    if (!net::StartSockets()) return;
+
+    listener_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener_ == net::kInvalidSocket) return;
+
+    auto address = sockaddr_in {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    auto length = static_cast<socklen_t>(sizeof(address));
+    if (bind(listener_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        listen(listener_, SOMAXCONN) != 0 ||
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        net::CloseSocket(listener_);
+        listener_ = net::kInvalidSocket;
+        return;
+    }
+
+    port_ = ntohs(address.sin_port);
+    acceptor_ = std::jthread {[this] { Accept(); }};
+}
+
+auto HttpServer::Accept() -> void {
+    while (true) {
+        const auto client = accept(listener_, nullptr, nullptr);
+        // the listener was shut down
+        if (client == net::kInvalidSocket) return;
+
+        net::ConfigureSocket(client, 30);
+        auto lock = std::scoped_lock {mutex_};
+        clients_.emplace_back(client);
+        connections_.emplace_back([this, client] { Serve(client); });
+    }
+}
+
+auto HttpServer::Serve(net::Socket client) -> void {
+    auto pending = std::string {};
+    auto chunk = std::array<char, 4096> {};
+    while (true) {
+        auto head_end = pending.find("\r\n\r\n");
+        while (head_end == std::string::npos && pending.size() < kMaxHeaderBytes) {
+            const auto received = recv(client, chunk.data(), static_cast<int>(chunk.size()), 0);
+            if (received <= 0) return;
+            pending.append(chunk.data(), static_cast<std::size_t>(received));
+            head_end = pending.find("\r\n\r\n");
+        }
+        if (head_end == std::string::npos) return;
+
+        requests_++;
+        const auto keep_open = Respond(client, std::string_view {pending}.substr(0, head_end));
+        // requests are GETs without a body
+        pending.erase(0, head_end + 4);
+        if (!keep_open) return;
+    }
+}
+
+auto HttpServer::Respond(net::Socket client, std::string_view head) -> bool {
+    const auto reply = [&](std::string_view status, std::string_view headers, std::string_view body) {
+        const auto response = std::format(
+            "HTTP/1.1 {}\r\nContent-Length: {}\r\n{}\r\n",
+            status, body.size(), headers
+        );
+        return net::SendAll(client, response) && net::SendAll(client, body);
+    };
+
+    // "GET /lod_0/tile.jpg HTTP/1.1"
+    const auto method_end = head.find(' ');
+    const auto target_end = head.find(' ', method_end + 1);
+    if (method_end == std::string_view::npos || target_end == std::string_view::npos) {
+        reply("400 Bad Request", "Connection: close\r\n", "");
+        return false;
+    }
+    if (head.substr(0, method_end) != "GET") {
+        return reply("405 Method Not Allowed", "", "");
+    }
+
+    auto target = head.substr(method_end + 1, target_end - method_end - 1);
+    target = target.substr(0, target.find('?'));
+    const auto path = root_ / fs::path {target.substr(std::min<std::size_t>(1, target.size()))};
+    if (target.find("..") != std::string_view::npos || !fs::is_regular_file(path)) {
+        return reply("404 Not Found", "", "");
+    }
+
+    // a single "Range: bytes=first-last" header, either end may be open
+    const auto size = static_cast<std::uint64_t>(fs::file_size(path));
+    if (size == 0) return reply("200 OK", "", "");
+    auto first = std::uint64_t {0};
+    auto last = size - 1;
+    auto ranged = false;
+    if (const auto range = head.find("\r\nRange: bytes="); range != std::string_view::npos) {
+        const auto spec = head.substr(range + 15, head.find("\r\n", range + 2) - range - 15);
+        const auto dash = spec.find('-');
+        if (dash != 0) std::from_chars(spec.data(), spec.data() + dash, first);
+        if (dash + 1 < spec.size()) std::from_chars(spec.data() + dash + 1, spec.data() + spec.size(), last);
+        last = std::min(last, size - 1);
+        if (first > last || first >= size) {
+            return reply("416 Range Not Satisfiable", std::format("Content-Range: bytes */{}\r\n", size), "");
+        }
+        ranged = true;
+    }
+
+    auto body = std::string(last - first + 1, '\0');
+    auto file = std::ifstream {path, std::ios::binary};
+    file.seekg(static_cast<std::streamoff>(first));
+    file.read(body.data(), static_cast<std::streamsize>(body.size()));
+
+    if (ranged) {
+        return reply("206 Partial Content", std::format("Content-Range: bytes {}-{}/{}\r\n", first, last, size), body);
+    }
+    return reply("200 OK", "", body);
+}
+
+HttpServer::~HttpServer() {
+    if (listener_ == net::kInvalidSocket) return;
+
+    net::ShutdownSocket(listener_);
+    net::CloseSocket(listener_);
+    acceptor_ = {};
+
+    // no new connections from here on, wake the ones blocked in recv()
+    auto connections = std::vector<std::jthread> {};
+    {
+        auto lock = std::scoped_lock {mutex_};
+        for (const auto client : clients_) net::ShutdownSocket(client);
+        connections = std::move(connections_);
+    }
+    connections.clear();
+
+    for (const auto client : clients_) net::CloseSocket(client);
+}
\ No newline at end of file
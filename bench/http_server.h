@@ -0,0 +1,54 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/socket.h"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Serves the files under a directory on 127.0.0.1 so the HTTP tile source
+// can run against local data in the same process. GET only, with single
+// byte ranges and keep-alive, one thread per connection.
+class HttpServer {
+public:
+    // Listens on an ephemeral port, Port() is 0 if that failed.
+    explicit HttpServer(const fs::path& root);
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    [[nodiscard]] auto Port() const { return port_; }
+
+    [[nodiscard]] auto Requests() const { return requests_.load(); }
+
+    ~HttpServer();
+
+private:
+    fs::path root_;
+
+    net::Socket listener_ {net::kInvalidSocket};
+    unsigned short port_ {0};
+
+    std::atomic<std::size_t> requests_ {0};
+
+    // open connections, shut down on destruction to end their threads
+    std::mutex mutex_;
+    std::vector<net::Socket> clients_ {};
+    std::vector<std::jthread> connections_ {};
+
+    std::jthread acceptor_ {};
+
+    auto Accept() -> void;
+
+    auto Serve(net::Socket client) -> void;
+
+    auto Respond(net::Socket client, std::string_view head) -> bool;
+};
\ No newline at end of file
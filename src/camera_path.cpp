@@ -0,0 +1,75 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "camera_path.h"
+
+#include <bit>
+#include <format>
+#include <fstream>
+
+#include <glm/gtc/type_ptr.hpp>
+
+// frames are read and written as raw floats
+static_assert(std::endian::native == std::endian::little);
+
+// delta and the 4x4 transform
+static constexpr auto kFrameBytes = sizeof(float) * 17;
+
+using namespace camera_path;
+
+auto CameraPath::Load(const fs::path& path) -> std::expected<CameraPath, std::string> {
+    auto file = std::ifstream {path, std::ios::binary};
+    if (!file) {
+        return std::unexpected(std::format("Failed to open camera path '{}'", path.string()));
+    }
+
+    auto header = Header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kMagic) {
+        return std::unexpected(std::format("Invalid camera path '{}'", path.string()));
+    }
+    if (header.version != kVersion) {
+        return std::unexpected(std::format("Unsupported camera path version {}", header.version));
+    }
+
+    // checked before allocating, the frame count comes from the file
+    auto error = std::error_code {};
+    const auto size = fs::file_size(path, error);
+    if (error || (size - sizeof(Header)) / kFrameBytes < header.frames) {
+        return std::unexpected(std::format("Truncated camera path '{}'", path.string()));
+    }
+
+    auto camera_path = CameraPath {};
+    camera_path.frames_.resize(header.frames);
+    for (auto& frame : camera_path.frames_) {
+        file.read(reinterpret_cast<char*>(&frame.delta), sizeof(float));
+        file.read(reinterpret_cast<char*>(glm::value_ptr(frame.transform)), sizeof(float) * 16);
+    }
+    if (!file) {
+        return std::unexpected(std::format("Truncated camera path '{}'", path.string()));
+    }
+
+    return camera_path;
+}
+
+auto CameraPath::Save(const fs::path& path) const -> std::expected<void, std::string> {
+    auto file = std::ofstream {path, std::ios::binary | std::ios::trunc};
+
+    const auto header = Header {
+        .magic = kMagic,
+        .version = kVersion,
+        .frames = static_cast<std::uint32_t>(frames_.size()),
+        .reserved = 0
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& frame : frames_) {
+        file.write(reinterpret_cast<const char*>(&frame.delta), sizeof(float));
+        file.write(reinterpret_cast<const char*>(glm::value_ptr(frame.transform)), sizeof(float) * 16);
+    }
+
+    if (!file) {
+        return std::unexpected(std::format("Failed to write camera path '{}'", path.string()));
+    }
+    return {};
+}
\ No newline at end of file
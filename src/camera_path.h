@@ -0,0 +1,59 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+namespace fs = std::filesystem;
+
+// File layout, all values little-endian:
+//   Header
+//   Frame[header.frames], delta as float then the transform column-major
+namespace camera_path {
+    constexpr auto kMagic = std::uint32_t {0x50434C47}; // 'GLCP'
+    constexpr auto kVersion = std::uint32_t {1};
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t frames;
+        std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 16);
+}
+
+// The camera transform of every frame, recorded from the viewer and played
+// back frame by frame so runs of different builds see the same navigation.
+class CameraPath {
+public:
+    struct Frame {
+        float delta; // seconds since the previous frame when recorded
+        glm::mat4 transform;
+    };
+
+    [[nodiscard]] static auto Load(const fs::path& path) -> std::expected<CameraPath, std::string>;
+
+    auto Save(const fs::path& path) const -> std::expected<void, std::string>;
+
+    auto Record(const glm::mat4& transform, double delta) -> void {
+        frames_.emplace_back(Frame {static_cast<float>(delta), transform});
+    }
+
+    [[nodiscard]] auto Frames() const { return frames_.size(); }
+
+    [[nodiscard]] auto operator[](std::size_t frame) const -> const Frame& {
+        return frames_[frame];
+    }
+
+private:
+    std::vector<Frame> frames_ {};
+};
\ No newline at end of file
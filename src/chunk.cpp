@@ -3,52 +3,196 @@
 
 #include "chunk.h"
 
-#include <random>
-#include <thread>
-#include <chrono>
+#include "core/tracer.h"
 
-#include <glm/mat4x4.hpp>
-#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
-Chunk::Chunk(const Params& params, const fs::path& path) : params_(params), source_(path) {
-    image_loader_ = ImageLoader::Create();
-}
+Chunk::Chunk(
+    const Params& params,
+    std::shared_ptr<TileSource> source,
+    std::shared_ptr<ImageLoader> loader,
+    std::shared_ptr<Completions> completions
+) :
+    params_(params),
+    source_(source),
+    completions_(completions),
+    image_loader_(loader) {}
 
-auto Chunk::Load() -> void {
-    if (state_ == ChunkState::Loading || state_ == ChunkState::Loaded) {
+auto Chunk::Load(const TaskPriority& priority, UploadRing* staging, TaskGroup* tasks) -> void {
+    const auto state = State();
+    if (state == ChunkState::Loading || state == ChunkState::Loaded) {
         return;
     }
 
-    state_ = ChunkState::Loading;
-
-    image_loader_->LoadAsync(source_, [this](const auto& image) {
-        if (image.has_value()) {
-            texture_.SetImage(image.value());
+    Tracer::Get().Record("requested", Key());
+    Transition(state, ChunkState::Loading);
+    requested_at_ = Clock::now();
+    priority_ = priority;
+    staging_ = staging;
+    load_token_ = std::make_shared<CancellationToken>();
 
-            static thread_local std::mt19937 rng(std::random_device{}());
+    // runs on the loader thread, nothing of the chunk is touched here. The
+    // tracked handle keeps the owner of staging waiting until the task is gone
+    auto callback = [
+        chunk = this,
+        key = Key(),
+        token = load_token_,
+        format = params_.format,
+        layout = params_.layout,
+        staging = staging_,
+        completions = completions_,
+        tracked = tasks ? tasks->Track() : nullptr
+    ](LoaderResult<Image> image) {
+        // the chunk was cancelled while the load was running
+        if (token->IsCancelled()) return;
 
-            if (params_.lod == 0) {
-                std::uniform_int_distribution dist(500, 2000);
-                std::this_thread::sleep_for(std::chrono::milliseconds(dist(rng)));
+        auto completion = Completion {.chunk = chunk, .token = token};
+        auto& tracer = Tracer::Get();
+        if (image.has_value()) {
+            const auto stage_start = tracer.Now();
+            completion.staged_segment = Stage(*image.value(), format, layout, staging);
+            if (completion.staged_segment < 0) {
+                // no segment free, the main thread uploads from the image
+                completion.image = std::make_unique<Image>(std::move(*image.value()));
             }
+            tracer.Record("stage", key, stage_start, tracer.Now());
+        } else {
+            tracer.Record("error", key);
+            completion.failed = true;
+        }
+        completions->Push(std::move(completion));
+    };
 
-            if (params_.lod == 1) {
-                std::uniform_int_distribution dist(100, 1000);
-                std::this_thread::sleep_for(std::chrono::milliseconds(dist(rng)));
-            }
+    const auto index = glm::uvec2 {params_.grid_index};
+    if (params_.source_lod == params_.lod) {
+        auto read = [source = source_, lod = params_.lod, index]() {
+            return source->Read(lod, index.x, index.y);
+        };
+        image_loader_->LoadAsync(std::move(read), callback, priority, DecodedBytes(), load_token_, Key());
+        return;
+    }
 
-            state_ = ChunkState::Loaded;
-            std::print("Loaded chunk {}\n", source_.string());
-        } else {
-            state_ = ChunkState::Error;
+    // the block of finer tiles covering this one, those past the edge of
+    // the image fail to read and are left black
+    const auto grid = 1u << (params_.lod - params_.source_lod);
+    auto reads = std::vector<LoaderSource> {};
+    reads.reserve(grid * grid);
+    for (auto y = 0u; y < grid; ++y) {
+        for (auto x = 0u; x < grid; ++x) {
+            const auto cell = index * grid + glm::uvec2 {x, y};
+            reads.emplace_back([source = source_, lod = params_.source_lod, cell]() {
+                return source->Read(lod, cell.x, cell.y);
+            });
+        }
+    }
+    image_loader_->LoadMosaicAsync(std::move(reads), grid, callback, priority, DecodedBytes(), load_token_, Key());
+}
+
+auto Chunk::Complete(Completion completion) -> bool {
+    // cancelled after the loader checked the token, or loading again since
+    const auto to = completion.failed ? ChunkState::Error : ChunkState::Loaded;
+    if (completion.token != load_token_ || !Transition(ChunkState::Loading, to)) {
+        if (completion.staged_segment >= 0) {
+            staging_->Discard(static_cast<unsigned int>(completion.staged_segment));
         }
-    });
+        return false;
+    }
+
+    load_token_ = nullptr;
+    image_ = std::move(completion.image);
+    staged_segment_ = completion.staged_segment;
+    return true;
+}
+
+auto Chunk::Cancel() -> void {
+    if (!Transition(ChunkState::Loading, ChunkState::Unloaded)) {
+        return;
+    }
+
+    Tracer::Get().Record("cancelled", Key());
+    load_token_->Cancel();
+    load_token_ = nullptr;
+}
+
+auto Chunk::Reprioritize(const TaskPriority& priority) -> void {
+    if (State() != ChunkState::Loading) {
+        return;
+    }
+
+    // ignore small moves to avoid reshuffling the queue on every frame
+    if (priority.level == priority_.level &&
+        std::abs(priority.distance - priority_.distance) < params_.size.x / 2.0f) {
+        return;
+    }
+
+    priority_ = priority;
+    ThreadPool::Get().Reprioritize(load_token_, priority);
+}
+
+auto Chunk::Release() -> void {
+    if (Transition(ChunkState::Loaded, ChunkState::Unloaded)) {
+        ClearImage();
+    }
+}
+
+auto Chunk::Fail() -> void {
+    if (Transition(ChunkState::Loaded, ChunkState::Error)) {
+        Tracer::Get().Record("error", Key());
+        ClearImage();
+    }
+}
+
+auto Chunk::ClearImage() -> void {
+    if (staged_segment_ >= 0) {
+        staging_->Discard(static_cast<unsigned int>(staged_segment_));
+        staged_segment_ = -1;
+    }
+    image_ = nullptr;
+    layer_ = -1;
+}
+
+auto Chunk::Transition(ChunkState from, ChunkState to) -> bool {
+    using enum ChunkState;
+    const auto allowed =
+        ((from == Unloaded || from == Error) && to == Loading) ||
+        (from == Loading && (to == Unloaded || to == Loaded || to == Error)) ||
+        (from == Loaded && (to == Unloaded || to == Error));
+    return allowed && state_.compare_exchange_strong(from, to, std::memory_order_acq_rel);
+}
+
+auto Chunk::Stage(
+    const Image& image,
+    PixelFormat format,
+    PixelLayout layout,
+    UploadRing* staging
+) -> int {
+    const auto bytes = image.Bytes();
+    auto staged = staging ? staging->TryAcquire() : std::nullopt;
+    if (staged && staged->memory.size() >= bytes && image.format == format && image.layout == layout) {
+        std::memcpy(staged->memory.data(), image.Data(), bytes);
+        return static_cast<int>(staged->segment);
+    }
+
+    // no segment free or the tile does not fit a layer
+    if (staged) staging->Discard(staged->segment);
+    return -1;
+}
+
+auto Chunk::SetLayer(int layer) -> void {
+    layer_ = layer;
+    staged_segment_ = -1;
+    image_ = nullptr;
+}
+
+auto Chunk::Bytes() const -> std::size_t {
+    return State() == ChunkState::Loaded ? DecodedBytes() : 0;
 }
 
-auto Chunk::ModelMatrix() const -> glm::mat4 {
-    return glm::translate(glm::mat4(1.0f), glm::vec3 {
-        params_.position.x + params_.size.x / 2.0f, // offset right
-        params_.position.y + params_.size.y / 2.0f, // offset up
-        0.0f
-    }) * glm::scale(glm::mat4(1.0f), glm::vec3 {params_.scale, params_.scale, 1.0f});
+auto Chunk::DecodedBytes() const -> std::size_t {
+    // tiles are decoded at their native resolution
+    const auto width = static_cast<unsigned int>(params_.size.x / params_.scale);
+    const auto height = static_cast<unsigned int>(params_.size.y / params_.scale);
+    return Image::Bytes(params_.format, params_.layout, width, height);
 }
\ No newline at end of file
@@ -3,17 +3,31 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
-#include <filesystem>
 
 #include <glm/vec2.hpp>
-#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
 
-#include "core/texture2d.h"
-#include "loaders/image_loader.h"
-
-namespace fs = std::filesystem;
+#include "tile_layout.h"
 
+#include "core/cancellation_token.h"
+#include "core/completion_queue.h"
+#include "core/image.h"
+#include "core/task_group.h"
+#include "core/thread_pool.h"
+#include "core/timer.h"
+#include "core/upload_ring.h"
+#include "loaders/image_loader.h"
+#include "loaders/tile_source.h"
+
+// Only the main thread changes the state, loader threads hand their results
+// over through a completion queue. The transitions are:
+//   Unloaded, Error -> Loading   Load()
+//   Loading -> Unloaded          Cancel()
+//   Loading -> Loaded, Error     Complete()
+//   Loaded -> Unloaded           Release()
+//   Loaded -> Error              Fail()
 enum class ChunkState {
     Unloaded,
     Loading,
@@ -29,14 +43,44 @@ public:
         glm::vec2 size;
         float scale {1.0f};
         unsigned lod;
+        // a finer LOD the tile is decoded from when its own isn't stored,
+        // see ImageLoader::LoadMosaicAsync(). The tile's own LOD otherwise.
+        unsigned source_lod;
+        // what the tile is decoded to, the format of the texture array
+        PixelFormat format {PixelFormat::R8};
+        PixelLayout layout {PixelLayout::YCbCr420};
+    };
+
+    // A finished load, pushed by the loader thread and applied with
+    // Complete() on the main thread.
+    struct Completion {
+        Chunk* chunk;
+        // the load it finishes, stale once that load was cancelled
+        std::shared_ptr<CancellationToken> token;
+        // decoded pixels, moved out of the loader and owned by the completion
+        // until the chunk takes them. Null when the pixels went into an
+        // upload ring segment instead or the load failed.
+        std::unique_ptr<Image> image {nullptr};
+        int staged_segment {-1};
+        bool failed {false};
     };
 
+    using Completions = CompletionQueue<Completion>;
+
     bool visible {false};
 
-    Chunk(const Params& params, const fs::path& path);
+    Chunk(
+        const Params& params,
+        std::shared_ptr<TileSource> source,
+        std::shared_ptr<ImageLoader> loader,
+        std::shared_ptr<Completions> completions
+    );
+
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
 
     [[nodiscard]] auto State() const -> ChunkState {
-        return state_;
+        return state_.load(std::memory_order_acquire);
     }
 
     [[nodiscard]] auto Position() const {
@@ -47,26 +91,132 @@ public:
         return params_.size;
     }
 
+    [[nodiscard]] auto GridIndex() const {
+        return params_.grid_index;
+    }
+
     [[nodiscard]] auto Lod() const {
         return params_.lod;
     }
 
-    [[nodiscard]] auto Texture() -> Texture2D& {
-        return texture_;
+    // Identifies the tile in traces, see tile_layout::TileKey.
+    [[nodiscard]] auto Key() const {
+        return tile_layout::TileKey(
+            params_.lod,
+            static_cast<unsigned>(params_.grid_index.x),
+            static_cast<unsigned>(params_.grid_index.y)
+        );
+    }
+
+    // The decoded image of a loaded chunk, null once it is uploaded or when
+    // the pixels went into an upload ring segment instead.
+    [[nodiscard]] auto PendingImage() const -> const Image* {
+        return image_.get();
+    }
+
+    // The upload ring segment holding the pixels, -1 if there is none.
+    [[nodiscard]] auto StagedSegment() const {
+        return staged_segment_;
+    }
+
+    // The texture array layer holding the chunk, -1 until it is uploaded.
+    [[nodiscard]] auto Layer() const {
+        return layer_;
+    }
+
+    [[nodiscard]] auto IsResident() const {
+        return layer_ >= 0;
+    }
+
+    // Records the layer the pending pixels were uploaded to and drops them.
+    auto SetLayer(int layer) -> void;
+
+    // When the current or last load was requested.
+    [[nodiscard]] auto RequestedAt() const {
+        return requested_at_;
     }
 
-    [[nodiscard]] auto ModelMatrix() const -> glm::mat4;
+    // Memory held by a loaded chunk, either the pending image or its layer.
+    [[nodiscard]] auto Bytes() const -> std::size_t;
+
+    // Decoded pixels are copied into a segment of staging when one is free.
+    // The result arrives through the completion queue. The load is tracked
+    // by tasks, if given, so the owner of staging can wait for it.
+    auto Load(
+        const TaskPriority& priority = {},
+        UploadRing* staging = nullptr,
+        TaskGroup* tasks = nullptr
+    ) -> void;
+
+    // Applies a drained completion, false if it belongs to a load that was
+    // cancelled in the meantime and was dropped. Main thread only.
+    auto Complete(Completion completion) -> bool;
+
+    // Drops a pending load, the chunk goes back to the unloaded state.
+    auto Cancel() -> void;
+
+    auto Reprioritize(const TaskPriority& priority) -> void;
 
-    auto Load() -> void;
+    // Forgets the image and layer of a loaded chunk, it can be loaded again
+    // later. The owner of the texture array takes the layer back first.
+    auto Release() -> void;
+
+    // Like Release(), for a chunk whose image could not be uploaded. It is
+    // not loaded again on its own.
+    auto Fail() -> void;
 
 private:
     Params params_;
 
-    fs::path source_;
+    std::shared_ptr<TileSource> source_ {nullptr};
+
+    std::shared_ptr<Completions> completions_ {nullptr};
+
+    std::atomic<ChunkState> state_ {ChunkState::Unloaded};
+
+    TaskPriority priority_ {};
+
+    Clock::time_point requested_at_ {};
 
-    ChunkState state_ {ChunkState::Unloaded};
+    std::shared_ptr<CancellationToken> load_token_ {nullptr};
 
     std::shared_ptr<ImageLoader> image_loader_ {nullptr};
 
-    Texture2D texture_ {};
+    std::unique_ptr<Image> image_ {nullptr};
+
+    UploadRing* staging_ {nullptr};
+
+    int staged_segment_ {-1};
+
+    int layer_ {-1};
+
+    [[nodiscard]] auto DecodedBytes() const -> std::size_t;
+
+    // Moves to the given state if the chunk is in the expected one and the
+    // transition is one of those listed with ChunkState.
+    auto Transition(ChunkState from, ChunkState to) -> bool;
+
+    // Drops the pending image, staged segment and layer of a loaded chunk.
+    auto ClearImage() -> void;
+
+    // Runs on the loader thread, copies the pixels into a segment of staging
+    // and returns it, -1 when none was free or the image isn't in the format
+    // of the texture array.
+    [[nodiscard]] static auto Stage(
+        const Image& image,
+        PixelFormat format,
+        PixelLayout layout,
+        UploadRing* staging
+    ) -> int;
+};
+
+// A resident chunk drawn over the footprint of a tile, its own or that of a
+// missing descendant it stands in for. In that case uv selects the part of
+// the chunk's texture that covers the footprint.
+struct TileDraw {
+    Chunk* chunk;
+    glm::vec2 position;
+    glm::vec2 size;
+    // xy offset and zw scale of the texture coordinates
+    glm::vec4 uv {0.0f, 0.0f, 1.0f, 1.0f};
 };
\ No newline at end of file
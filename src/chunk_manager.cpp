@@ -3,18 +3,132 @@
 
 #include "chunk_manager.h"
 
+#include "core/tracer.h"
+
+#include <algorithm>
+#include <chrono>
 #include <format>
+#include <iostream>
+
+// enough for stable percentiles, small enough to sort every frame
+static constexpr auto kLatencySamples = std::size_t {256};
+
+// JPEG DCT scaling goes down to 1/8, a tile is built from up to 8x8 tiles
+static constexpr auto kMaxDerivedLevels = 3;
+
+// chunks_ is not swept while it is smaller than this
+static constexpr auto kMinSweep = std::size_t {1024};
 
-#include <imgui.h>
+ChunkManager::ChunkManager(const Parameters& params, RenderBackend& backend) :
+    ChunkManager(params, backend, OpenSource(params, ComputeGrids(params.image_dims, params.lods))) {}
 
-ChunkManager::ChunkManager(const Parameters& params) :
+ChunkManager::ChunkManager(const Parameters& params, RenderBackend& backend, OpenedSource opened) :
+    grid_sizes_(ComputeGrids(params.image_dims, params.lods)),
+    image_loader_(ImageLoader::Create({
+        .layout = PixelLayout::YCbCr420,
+        .keep_gray = opened.layout == PixelLayout::Interleaved
+    })),
+    source_(std::move(opened.tiles)),
+    completions_(std::make_shared<Chunk::Completions>(params.on_load)),
+    format_(opened.format),
+    layout_(opened.layout),
+    tile_bytes_(Image::Bytes(format_, layout_, tile_layout::kTileSize, tile_layout::kTileSize)),
+    atlas_(backend, {
+        .width = tile_layout::kTileSize,
+        .height = tile_layout::kTileSize,
+        .layers = static_cast<unsigned int>(params.memory_budget / tile_bytes_),
+        .format = format_,
+        .layout = layout_
+    }),
+    staging_(backend, {
+        .segment_bytes = tile_bytes_,
+        .segments = 8
+    }),
+    residency_(params.memory_budget, [this](Chunk* chunk) { ReleaseChunk(chunk); }),
+    uploads_(params.uploads),
+    prefetch_(params.prefetch),
     image_dims_(params.image_dims),
     window_dims_(params.window_dims),
     lods_(params.lods),
     max_lod_(params.lods - 1)
 {
-    chunks_.resize(lods_);
-    GenerateChunks();
+    // the backend may allocate fewer layers than the budget asks for, the
+    // cache has to evict before the atlas runs out
+    residency_.SetBudget(std::min(params.memory_budget, atlas_.Layers() * tile_bytes_));
+
+    visible_ranges_.resize(lods_);
+    prefetch_ranges_.resize(lods_);
+    ComputeSourceLods(opened.stored, params.derive_above);
+
+    if (params.simulate) {
+        source_ = std::make_shared<SimulatedTileSource>(source_, params.simulate.value());
+    }
+
+    // the coarsest LOD is the fallback for everything, load it up front
+    const auto all = TileRange {.min = {0, 0}, .max = grid_sizes_[max_lod_]};
+    ForEachChunk(max_lod_, all, [&](Chunk& chunk) {
+        chunk.Load({}, &staging_, &loads_);
+        pending_.emplace_back(&chunk);
+    });
+}
+
+auto ChunkManager::OpenSource(const Parameters& params, const std::vector<glm::ivec2>& grid_sizes) -> OpenedSource {
+    const auto lods = params.lods;
+    auto grids = std::vector<TileGrid> {};
+    for (const auto& size : grid_sizes) {
+        grids.emplace_back(TileGrid {
+            .grid_x = static_cast<unsigned>(size.x),
+            .grid_y = static_cast<unsigned>(size.y)
+        });
+    }
+
+    // LODs the source has tiles for, the others are decoded from finer ones
+    auto opened = OpenedSource {.stored = std::vector<bool>(lods, true)};
+    if (!params.url.empty()) {
+        if (auto http = HttpTileSource::Open({.url = params.url, .grids = grids})) {
+            opened.tiles = http.value();
+            for (auto lod = 0; lod < lods; ++lod) {
+                opened.stored[lod] = static_cast<unsigned>(lod) < http.value()->Lods();
+            }
+        } else {
+            std::cerr << http.error() << '\n';
+        }
+    }
+
+    if (opened.tiles == nullptr && !params.pack.empty()) {
+        if (auto pack = TilePack::Open(params.pack)) {
+            opened.tiles = std::make_shared<PackTileSource>(pack.value());
+            for (auto lod = 0; lod < lods; ++lod) {
+                opened.stored[lod] = static_cast<unsigned>(lod) < pack.value()->Lods();
+            }
+        } else {
+            std::cerr << pack.error() << '\n';
+        }
+    }
+
+    if (opened.tiles == nullptr) {
+        opened.tiles = std::make_shared<FileTileSource>(std::move(grids), tile_layout::kRoot);
+        for (auto lod = 0; lod < lods; ++lod) {
+            opened.stored[lod] = fs::exists(tile_layout::TilePath(static_cast<unsigned>(lod), 1));
+        }
+    }
+
+    // the tiles of a pyramid share a format, the coarsest stored one decides
+    // the format of the texture array: YCbCr planes for colour, a single
+    // plane for grayscale
+    const auto loader = ImageLoader::Create({.layout = PixelLayout::YCbCr420});
+    for (auto lod = lods - 1; lod >= 0; --lod) {
+        if (!opened.stored[lod]) continue;
+        const auto tile = opened.tiles->Read(static_cast<unsigned>(lod), 0, 0);
+        if (!tile) break;
+        if (const auto image = loader->Decode(tile->bytes, tile->name)) {
+            opened.format = image->format;
+            opened.layout = image->layout;
+        }
+        break;
+    }
+
+    return opened;
 }
 
 auto ChunkManager::ComputeLod(const OrthographicCamera& camera) const -> int {
@@ -25,7 +139,7 @@ auto ChunkManager::ComputeLod(const OrthographicCamera& camera) const -> int {
     return std::clamp(static_cast<int>(std::floor(lod_f)), 0, max_lod_);
 }
 
-auto ChunkManager::Update(const OrthographicCamera& camera) -> void {
+auto ChunkManager::Update(const OrthographicCamera& camera, const CameraMotion& motion) -> void {
     auto this_lod = ComputeLod(camera);
     if (this_lod != curr_lod) {
         prev_lod = curr_lod;
@@ -33,82 +147,403 @@ auto ChunkManager::Update(const OrthographicCamera& camera) -> void {
     }
 
     visible_bounds_ = ComputeVisibleBounds(camera);
+    residency_.BeginFrame();
+    changed_ = false;
 
-    for (auto lod = 0; lod < lods_; ++lod) {
-        for (auto& chunk : chunks_[lod]) {
-            chunk.visible = IsChunkVisible(chunk);
-            if (curr_lod == lod && chunk.visible && chunk.State() == ChunkState::Unloaded) {
-                chunk.Load();
+    // the only place loads settle, pending chunks aren't polled for it
+    completions_->Drain([this](Chunk::Completion&& completion) {
+        // the chunk of a cancelled load may have been swept since
+        if (completion.token->IsCancelled()) {
+            if (completion.staged_segment >= 0) {
+                staging_.Discard(static_cast<unsigned int>(completion.staged_segment));
+            }
+            return;
+        }
+        const auto chunk = completion.chunk;
+        if (chunk->Complete(std::move(completion)) && chunk->State() == ChunkState::Loaded) {
+            residency_.Track(chunk, static_cast<int>(chunk->Lod()) == max_lod_);
+        }
+    });
+
+    UpdateVisibility();
+
+    // settled chunks are either resident and tracked, or gone
+    std::erase_if(pending_, [](const Chunk* chunk) {
+        return chunk->State() == ChunkState::Unloaded ||
+               chunk->State() == ChunkState::Error ||
+               chunk->IsResident();
+    });
+
+    SweepChunks();
+
+    if (curr_lod != max_lod_) {
+        ForEachChunk(curr_lod, visible_ranges_[curr_lod], [&](Chunk& chunk) {
+            if (chunk.State() == ChunkState::Unloaded) {
+                chunk.Load(LoadPriority(chunk), &staging_, &loads_);
+                pending_.emplace_back(&chunk);
+            } else {
+                chunk.Reprioritize(LoadPriority(chunk));
             }
+        });
+    }
+
+    Prefetch(motion);
+
+    for (auto chunk : pending_) {
+        const auto lod = static_cast<int>(chunk->Lod());
+        const auto wanted = (lod == curr_lod && chunk->visible) ||
+                            Contains(prefetch_ranges_[lod], chunk->GridIndex());
+        if (lod != max_lod_ && !wanted) {
+            // stale work left behind by a pan or a LOD change
+            chunk->Cancel();
         }
     }
+
+    UploadPending();
 };
 
-auto ChunkManager::GenerateChunks() -> void {
-    for (auto i = 0u; i < lods_; ++i) {
-        const auto lod_width = static_cast<float>(image_dims_.width) / (1 << i);
-        const auto lod_height = static_cast<float>(image_dims_.height) / (1 << i);
-        const auto scale = static_cast<float>(pow(2, i));
-        const auto grid_x = static_cast<int>(lod_width / kChunkSize);
-        const auto grid_y = static_cast<int>(lod_height / kChunkSize);
-        const auto n_chunks = grid_x * grid_y;
+auto ChunkManager::UpdateVisibility() -> void {
+    for (auto lod = 0; lod < lods_; ++lod) {
+        ForEachChunk(lod, visible_ranges_[lod], [](Chunk& chunk) {
+            chunk.visible = false;
+        });
+
+        // only the LODs that can be drawn are kept up to date
+        const auto drawn = lod == curr_lod || lod == max_lod_;
+        const auto previous = visible_ranges_[lod];
+        visible_ranges_[lod] = drawn ? ComputeTileRange(lod, visible_bounds_) : TileRange {};
+
+        ForEachChunk(lod, visible_ranges_[lod], [&](Chunk& chunk) {
+            chunk.visible = true;
+            // a tile coming into view at the LOD being drawn is a cache lookup
+            if (lod == curr_lod && !Contains(previous, chunk.GridIndex())) {
+                residency_.CountLookup(chunk.State() == ChunkState::Loaded);
+            }
+        });
+    }
+}
+
+auto ChunkManager::Prefetch(const CameraMotion& motion) -> void {
+    // in a full cache every prefetched tile evicts another one, which may
+    // be prefetched again. The ranges are kept like below
+    const auto residency = residency_.GetStats();
+    if (residency.resident_bytes >= residency.budget) return;
+
+    // what prefetching holds: loads in flight, and loaded tiles that haven't
+    // been drawn yet, the rest of the cache is left to the residency budget
+    auto used = residency.undrawn_bytes;
+    for (const auto chunk : pending_) {
+        if (chunk->State() == ChunkState::Loading) used += tile_bytes_;
+    }
+    // keep the last ranges so the loads already in flight aren't cancelled
+    if (used >= prefetch_.memory_budget) return;
+
+    for (auto& range : prefetch_ranges_) range = {};
+
+    // extrapolate the viewport along the current pan and zoom
+    const auto idle = glm::length(motion.pan) < 1.0f && std::abs(motion.zoom) < 0.01f;
+    const auto center = (visible_bounds_.min + visible_bounds_.max) / 2.0f;
+    const auto half_size = (visible_bounds_.max - visible_bounds_.min) / 2.0f;
+    const auto ahead_center = center + motion.pan * prefetch_.lookahead;
+    const auto ahead_half_size = half_size * std::exp2(motion.zoom * prefetch_.lookahead);
+    const auto ahead = Bounds {
+        .min = ahead_center - ahead_half_size,
+        .max = ahead_center + ahead_half_size
+    };
+
+    const auto queue = [&](int lod, const TileRange& range, int level) {
+        prefetch_ranges_[lod] = range;
+
+        prefetch_candidates_.clear();
+        ForEachChunk(lod, range, [&](Chunk& chunk) {
+            if (chunk.State() == ChunkState::Unloaded) {
+                const auto chunk_center = chunk.Position() + chunk.Size() / 2.0f;
+                prefetch_candidates_.emplace_back(&chunk, TaskPriority {
+                    .level = level,
+                    .distance = glm::length(chunk_center - ahead_center)
+                });
+            }
+        });
 
-        for (auto j = 1; j <= n_chunks; ++j) {
-            auto x = (j - 1) % grid_x;
-            auto y = (j - 1) / grid_y;
-            auto path = std::format("assets/lod_{}/spiralcrop{}_{:02}.jpg", i, i, j);
-            chunks_[i].emplace_back(Chunk::Params {
-                .grid_index = {x, y},
-                .position = {x * kChunkSize * scale, y * kChunkSize * scale},
-                .size = {kChunkSize * scale, kChunkSize * scale},
-                .scale = scale,
-                .lod = i
-            }, path);
+        // nearest first, so the budget is spent around the viewport
+        std::ranges::sort(prefetch_candidates_, {}, [](const auto& c) { return c.second; });
+        for (const auto& [chunk, priority] : prefetch_candidates_) {
+            if (used >= prefetch_.memory_budget) return;
+            chunk->Load(priority, &staging_, &loads_);
+            pending_.emplace_back(chunk);
+            used += tile_bytes_;
+            prefetch_loads_++;
         }
+    };
+
+    // a ring around the predicted viewport at the current LOD, widened while
+    // the camera is idle to fill the neighbourhood in the background
+    if (curr_lod != max_lod_) {
+        const auto margin = idle ? prefetch_.idle_margin : prefetch_.margin;
+        const auto range = Union(visible_ranges_[curr_lod], ComputeTileRange(curr_lod, ahead));
+        queue(curr_lod, Expand(range, margin, grid_sizes_[curr_lod]), 1);
     }
 
-    for (auto& chunk : chunks_[max_lod_]) {
-        chunk.Load();
+    // the LOD the zoom is heading into
+    if (!idle && std::abs(motion.zoom) >= 0.01f) {
+        const auto next_lod = std::clamp(curr_lod + (motion.zoom > 0.0f ? 1 : -1), 0, max_lod_);
+        if (next_lod != curr_lod && next_lod != max_lod_) {
+            const auto range = ComputeTileRange(next_lod, ahead);
+            queue(next_lod, Expand(range, prefetch_.margin, grid_sizes_[next_lod]), 2);
+        }
     }
 }
 
-auto ChunkManager::GetVisibleChunks() -> std::vector<Chunk*> {
-    std::vector<Chunk*> visible_chunks;
+auto ChunkManager::Expand(const TileRange& range, int margin, glm::ivec2 grid) -> TileRange {
+    if (range.min.x >= range.max.x || range.min.y >= range.max.y) return range;
+    return {
+        .min = glm::max(range.min - margin, glm::ivec2 {0}),
+        .max = glm::min(range.max + margin, grid)
+    };
+}
+
+auto ChunkManager::Union(const TileRange& a, const TileRange& b) -> TileRange {
+    if (a.min.x >= a.max.x || a.min.y >= a.max.y) return b;
+    if (b.min.x >= b.max.x || b.min.y >= b.max.y) return a;
+    return {.min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max)};
+}
+
+auto ChunkManager::ComputeTileRange(int lod, const Bounds& bounds) const -> TileRange {
+    const auto tile_size = kChunkSize * static_cast<float>(1 << lod);
+    const auto bounds_min = glm::min(bounds.min, bounds.max) / tile_size;
+    const auto bounds_max = glm::max(bounds.min, bounds.max) / tile_size;
+    const auto grid = grid_sizes_[lod];
+
+    // tiles touching the bounds count as visible, like the old per-tile test
+    return {
+        .min = glm::clamp(glm::ivec2 {glm::floor(bounds_min)}, glm::ivec2 {0}, grid),
+        .max = glm::clamp(glm::ivec2 {glm::floor(bounds_max)} + 1, glm::ivec2 {0}, grid)
+    };
+}
+
+auto ChunkManager::UploadPending() -> void {
+    staging_.Reclaim();
 
-    // always include low-res tiles
-    for (auto& chunk : chunks_[max_lod_]) {
-        if (chunk.visible && chunk.State() == ChunkState::Loaded) {
-            visible_chunks.push_back(&chunk);
+    const auto viewport_center = (visible_bounds_.min + visible_bounds_.max) / 2.0f;
+    for (auto chunk : pending_) {
+        if (chunk->State() != ChunkState::Loaded || chunk->IsResident()) continue;
+
+        // visible tiles of the current LOD, then ancestors that stand in for
+        // the ones still missing, then whatever else has arrived
+        auto rank = 2;
+        if (chunk->visible && static_cast<int>(chunk->Lod()) == curr_lod) {
+            rank = 0;
+        } else if (CoversMissingTile(*chunk)) {
+            rank = 1;
         }
+
+        const auto chunk_center = chunk->Position() + chunk->Size() / 2.0f;
+        uploads_.Enqueue(chunk, {
+            .level = rank,
+            .distance = glm::length(chunk_center - viewport_center)
+        });
     }
 
-    if (curr_lod == max_lod_) return visible_chunks;
+    uploads_.Run([this](Chunk* chunk) {
+        // out of layers, retry once eviction has freed some
+        const auto layer = atlas_.Acquire();
+        if (!layer) return false;
 
-    // collect all visible chunks from the current LOD
-    bool all_loaded = true;
-    for (auto& chunk : chunks_[curr_lod]) {
-        if (chunk.visible) {
-            visible_chunks.push_back(&chunk);
-            if (chunk.State() != ChunkState::Loaded) {
-                all_loaded = false;
-            }
+        auto& tracer = Tracer::Get();
+        const auto upload_start = tracer.Now();
+        if (chunk->StagedSegment() >= 0) {
+            const auto segment = static_cast<unsigned int>(chunk->StagedSegment());
+            staging_.CopyTo(segment, layer.value());
+            chunk->SetLayer(static_cast<int>(layer.value()));
+            AddLoadLatency(*chunk);
+            changed_ = true;
+        } else if (atlas_.Upload(layer.value(), *chunk->PendingImage())) {
+            chunk->SetLayer(static_cast<int>(layer.value()));
+            AddLoadLatency(*chunk);
+            changed_ = true;
+        } else {
+            // a tile that can't be uploaded won't upload on a retry either
+            atlas_.Release(layer.value());
+            residency_.Remove(chunk);
+            chunk->Fail();
         }
+        tracer.Record("upload", chunk->Key(), upload_start, tracer.Now());
+        return true;
+    });
+}
+
+auto ChunkManager::ReleaseChunk(Chunk* chunk) -> void {
+    Tracer::Get().Record("evicted", chunk->Key());
+    if (chunk->IsResident()) {
+        atlas_.Release(static_cast<unsigned int>(chunk->Layer()));
+        changed_ = true;
     }
+    chunk->Release();
+}
+
+auto ChunkManager::AddLoadLatency(const Chunk& chunk) -> void {
+    const auto latency = std::chrono::duration<float, std::milli>(Clock::now() - chunk.RequestedAt());
+    if (load_latencies_.size() < kLatencySamples) {
+        load_latencies_.emplace_back(latency.count());
+    } else {
+        load_latencies_[next_latency_] = latency.count();
+    }
+    next_latency_ = (next_latency_ + 1) % kLatencySamples;
+}
+
+auto ChunkManager::LoadPriority(const Chunk& chunk) const -> TaskPriority {
+    const auto viewport_center = (visible_bounds_.min + visible_bounds_.max) / 2.0f;
+    const auto chunk_center = chunk.Position() + chunk.Size() / 2.0f;
+    return {
+        .level = std::abs(static_cast<int>(chunk.Lod()) - curr_lod),
+        .distance = glm::length(chunk_center - viewport_center)
+    };
+}
 
-    // if not all chunks are loaded, add the previous LOD
-    if (!all_loaded && curr_lod != max_lod_) {
-        for (auto& chunk : chunks_[prev_lod]) {
-            if (chunk.visible && chunk.State() == ChunkState::Loaded) {
-                visible_chunks.push_back(&chunk);
+auto ChunkManager::ComputeGrids(Dimensions image_dims, int lods) -> std::vector<glm::ivec2> {
+    auto grid_sizes = std::vector<glm::ivec2> {};
+    for (auto lod = 0; lod < lods; ++lod) {
+        // same rounding as pyramid-build, padded edge tiles included
+        grid_sizes.emplace_back(
+            static_cast<int>(tile_layout::GridSize(image_dims.width, static_cast<unsigned int>(lod))),
+            static_cast<int>(tile_layout::GridSize(image_dims.height, static_cast<unsigned int>(lod)))
+        );
+    }
+    return grid_sizes;
+}
+
+auto ChunkManager::ComputeSourceLods(const std::vector<bool>& stored, int derive_above) -> void {
+    for (auto lod = 0; lod < lods_; ++lod) {
+        const auto derived = !stored[lod] || (derive_above >= 0 && lod > derive_above);
+        auto source = lod;
+        for (auto finer = lod - 1; derived && finer >= std::max(0, lod - kMaxDerivedLevels); --finer) {
+            if (stored[finer] && (derive_above < 0 || finer <= derive_above)) {
+                source = finer;
+                break;
             }
         }
+        if (!stored[lod] && source == lod) {
+            std::cerr << std::format("LOD {} is missing and no finer LOD to decode it from is stored\n", lod);
+        }
+        source_lods_.emplace_back(static_cast<unsigned>(source));
     }
+}
+
+auto ChunkManager::GetChunk(int lod, int x, int y) -> Chunk& {
+    const auto key = tile_layout::TileKey(
+        static_cast<unsigned>(lod),
+        static_cast<unsigned>(x),
+        static_cast<unsigned>(y)
+    );
+    auto& chunk = chunks_[key];
+    if (chunk) return *chunk;
 
-    if (all_loaded && prev_lod != curr_lod && prev_lod != max_lod_) {
-        // TODO: release previous LOD memory
+    const auto scale = static_cast<float>(1 << lod);
+    const auto params = Chunk::Params {
+        .grid_index = {x, y},
+        .position = {x * kChunkSize * scale, y * kChunkSize * scale},
+        .size = {kChunkSize * scale, kChunkSize * scale},
+        .scale = scale,
+        .lod = static_cast<unsigned>(lod),
+        .source_lod = source_lods_[lod],
+        .format = format_,
+        .layout = layout_
+    };
+    chunk = std::make_unique<Chunk>(params, source_, image_loader_, completions_);
+    return *chunk;
+}
+
+auto ChunkManager::SweepChunks() -> void {
+    if (chunks_.size() < std::max(sweep_at_, kMinSweep)) return;
+
+    // pending_ holds no unloaded chunks here and the residency cache only
+    // tracks loaded ones, so nothing else points at what is erased
+    std::erase_if(chunks_, [](const auto& entry) {
+        const auto& chunk = *entry.second;
+        return chunk.State() == ChunkState::Unloaded && !chunk.visible;
+    });
+    sweep_at_ = chunks_.size() * 2;
+}
+
+auto ChunkManager::GetVisibleTiles() -> std::span<const TileDraw> {
+    draws_.clear();
+    fallbacks_ = 0;
+
+    ForEachChunk(curr_lod, visible_ranges_[curr_lod], [&](Chunk& chunk) {
+        // kept while it waits for an upload, even if an ancestor is drawn
+        if (chunk.State() == ChunkState::Loaded && !chunk.IsResident()) {
+            residency_.KeepAlive(&chunk, static_cast<int>(chunk.Lod()) == max_lod_);
+        }
+
+        // the always-loaded base LOD is only the last resort
+        const auto source = chunk.IsResident() ? &chunk : FindResidentAncestor(chunk);
+        if (source == nullptr) return;
+        if (source != &chunk) fallbacks_++;
+        residency_.Touch(source, static_cast<int>(source->Lod()) == max_lod_);
+
+        draws_.emplace_back(TileDraw {
+            .chunk = source,
+            .position = chunk.Position(),
+            .size = chunk.Size(),
+            .uv = {(chunk.Position() - source->Position()) / source->Size(), chunk.Size() / source->Size()}
+        });
+    });
+
+    // everything not drawn this frame is a candidate, including the previous
+    // LOD, prefetched tiles still ahead of the camera go last
+    residency_.Evict([this](const Chunk* chunk) {
+        return Contains(prefetch_ranges_[chunk->Lod()], chunk->GridIndex());
+    });
+
+    return draws_;
+}
+
+auto ChunkManager::FindResidentAncestor(const Chunk& chunk) const -> Chunk* {
+    auto index = chunk.GridIndex();
+    for (auto lod = static_cast<int>(chunk.Lod()) + 1; lod <= max_lod_; ++lod) {
+        index = index / 2;
+        const auto key = tile_layout::TileKey(
+            static_cast<unsigned>(lod),
+            static_cast<unsigned>(index.x),
+            static_cast<unsigned>(index.y)
+        );
+        const auto found = chunks_.find(key);
+        if (found != end(chunks_) && found->second->IsResident()) {
+            return found->second.get();
+        }
     }
+    return nullptr;
+}
+
+auto ChunkManager::CoversMissingTile(const Chunk& chunk) const -> bool {
+    const auto levels = static_cast<int>(chunk.Lod()) - curr_lod;
+    if (levels <= 0) return false;
+
+    // the visible tiles of the current LOD under the chunk
+    const auto& visible = visible_ranges_[curr_lod];
+    const auto first = glm::max(chunk.GridIndex() * (1 << levels), visible.min);
+    const auto last = glm::min((chunk.GridIndex() + 1) * (1 << levels), visible.max);
+    for (auto y = first.y; y < last.y; ++y) {
+        for (auto x = first.x; x < last.x; ++x) {
+            const auto key = tile_layout::TileKey(
+                static_cast<unsigned>(curr_lod),
+                static_cast<unsigned>(x),
+                static_cast<unsigned>(y)
+            );
+            const auto found = chunks_.find(key);
+            if (found == end(chunks_) || !found->second->IsResident()) return true;
+        }
+    }
+    return false;
+}
 
-    return visible_chunks;
+auto ChunkManager::IsSharp() -> bool {
+    auto sharp = true;
+    ForEachChunk(curr_lod, visible_ranges_[curr_lod], [&](Chunk& chunk) {
+        // a tile that failed to load won't get any sharper
+        if (!chunk.IsResident() && chunk.State() != ChunkState::Error) sharp = false;
+    });
+    return sharp;
 }
 
 auto ChunkManager::ComputeVisibleBounds(const OrthographicCamera& camera) const -> Bounds {
@@ -126,36 +561,11 @@ auto ChunkManager::ComputeVisibleBounds(const OrthographicCamera& camera) const
     };
 }
 
-auto ChunkManager::IsChunkVisible(const Chunk& chunk) const -> bool {
-    const Bounds chunk_bounds = {
-        .min = chunk.Position(),
-        .max = chunk.Position() + chunk.Size()
-    };
-
-    const auto chunk_min = glm::min(chunk_bounds.min, chunk_bounds.max);
-    const auto chunk_max = glm::max(chunk_bounds.min, chunk_bounds.max);
-    const auto bounds_min = glm::min(visible_bounds_.min, visible_bounds_.max);
-    const auto bounds_max = glm::max(visible_bounds_.min, visible_bounds_.max);
-
-    return (chunk_min.x <= bounds_max.x && chunk_max.x >= bounds_min.x) &&
-           (chunk_min.y <= bounds_max.y && chunk_max.y >= bounds_min.y);
-}
-
-auto ChunkManager::Debug() -> void {
-    ImGui::SetNextWindowFocus();
-    ImGui::Begin("Chunk Manager");
-    ImGui::Text("Image dimensions: %dx%d", image_dims_.width, image_dims_.height);
-    ImGui::Text("Current LOD: %d", curr_lod);
-    ImGui::Separator();
-    ImGui::Checkbox("Show Wireframes", &show_wireframes);
-    ImGui::Separator();
-    ImGui::Text(" V  L  ");
-    for (auto lod = max_lod_; lod >= 0; --lod) {
-        for (auto i = 0; i < chunks_[lod].size(); ++i) {
-            const auto visible = chunks_[lod][i].visible ? "X" : " ";
-            const auto loaded = chunks_[lod][i].State() == ChunkState::Loaded ? "X" : " ";
-            ImGui::Text("[%s][%s] LOD_%d_CHUNK_%d", visible, loaded, lod, i);
-        }
+ChunkManager::~ChunkManager() {
+    for (auto& [key, chunk] : chunks_) {
+        chunk->Cancel();
     }
-    ImGui::End();
+    // cancelled jobs deep in the queue are only dropped when purged
+    ThreadPool::Get().PurgeCancelled();
+    loads_.Wait();
 }
\ No newline at end of file
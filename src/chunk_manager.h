@@ -4,16 +4,38 @@
 #pragma once
 
 #include "chunk.h"
+#include "residency_cache.h"
+#include "tile_layout.h"
+#include "upload_scheduler.h"
 
 #include "core/orthographic_camera.h"
+#include "core/render_backend.h"
+#include "core/task_group.h"
+#include "core/texture_array.h"
+#include "core/upload_ring.h"
+#include "loaders/http_tile_source.h"
+#include "loaders/image_loader.h"
+#include "loaders/tile_pack.h"
+#include "loaders/tile_source.h"
+#include "resources/zoom_pan_camera.h"
 
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <glm/vec2.hpp>
+#include <glm/vector_relational.hpp>
 
 class ChunkManager {
 public:
-    constexpr static auto kChunkSize = 512.0f;
+    constexpr static auto kChunkSize = static_cast<float>(tile_layout::kTileSize);
 
     int curr_lod {0};
     int prev_lod {0};
@@ -29,22 +51,153 @@ public:
         glm::vec2 max {0.0f};
     };
 
+    // Tiles [min, max) of a LOD grid.
+    struct TileRange {
+        glm::ivec2 min {0};
+        glm::ivec2 max {0};
+    };
+
+    struct PrefetchParameters {
+        // seconds the viewport is extrapolated along the camera velocity
+        float lookahead {0.3f};
+        // tiles around the predicted viewport, and while the camera is idle
+        int margin {1};
+        int idle_margin {3};
+        // prefetching pauses once in-flight tiles and loaded tiles that were
+        // never drawn reach this, keep it under memory_budget so prefetched
+        // tiles aren't evicted
+        std::size_t memory_budget {128u << 20};
+    };
+
     struct Parameters {
         Dimensions image_dims;
         Dimensions window_dims;
         int lods {0};
+        // optional, tiles are read from loose files under assets/ when empty
+        fs::path pack {};
+        // optional, overrides pack: a tile pack URL ending in .pack, or the
+        // URL loose tiles are laid out under
+        std::string url {};
+        // delays every tile read like remote storage when set
+        std::optional<SimulatedTileSource::Parameters> simulate {};
+        // LODs above this one are decoded from finer tiles even when they
+        // are stored, -1 to only decode the LODs the source doesn't have
+        int derive_above {-1};
+        // bytes of decoded tiles kept resident, CPU and GPU combined, the
+        // tile texture array is sized to hold this many bytes of tiles
+        std::size_t memory_budget {256u << 20};
+        // per-frame limits on texture uploads
+        UploadScheduler::Parameters uploads {};
+        PrefetchParameters prefetch {};
+        // called on a loader thread whenever a load finishes, e.g. to wake
+        // a frame loop that is waiting for events
+        std::function<void()> on_load {};
     };
 
-    explicit ChunkManager(const Parameters& params);
+    // Tile storage and upload segments are allocated up front on the backend,
+    // in the format the source's coarsest tile decodes to.
+    ChunkManager(const Parameters& params, RenderBackend& backend);
+
+    // Motion drives prefetching, tiles only load once visible without it.
+    auto Update(const OrthographicCamera& camera, const CameraMotion& motion = {}) -> void;
+
+    // One entry per visible tile of the current LOD that has something to
+    // show: the tile itself once resident, otherwise the part of its
+    // nearest resident ancestor covering it. Nothing is drawn underneath, so
+    // every pixel is shaded about once. Valid until the next call.
+    auto GetVisibleTiles() -> std::span<const TileDraw>;
 
-    auto Debug() -> void;
+    [[nodiscard]] auto Residency() const -> ResidencyCache::Stats {
+        return residency_.GetStats();
+    }
 
-    auto Update(const OrthographicCamera& camera) -> void;
+    [[nodiscard]] auto Uploads() const -> UploadScheduler::Stats {
+        return uploads_.GetStats();
+    }
 
-    auto GetVisibleChunks() -> std::vector<Chunk*>;
+    // Milliseconds from request to resident of the latest loads, unordered.
+    [[nodiscard]] auto LoadLatencies() const -> std::span<const float> {
+        return load_latencies_;
+    }
+
+    // True when every visible chunk of the current LOD is on the GPU.
+    [[nodiscard]] auto IsSharp() -> bool;
+
+    // True when the last Update() and GetVisibleTiles() uploaded or evicted
+    // tiles, the picture is stale until it is drawn again.
+    [[nodiscard]] auto Changed() const {
+        return changed_;
+    }
+
+    // Chunks still loading or waiting for an upload.
+    [[nodiscard]] auto Pending() const {
+        return pending_.size();
+    }
+
+    // Cancels the loads in flight and waits for those already running.
+    ~ChunkManager();
 
 private:
-    std::vector<std::vector<Chunk>> chunks_;
+    // the debug panel reads and tunes the internals directly
+    friend class ChunkManagerPanel;
+
+    // created on first touch, keyed by tile_layout::TileKey. Unloaded chunks
+    // out of view are swept once the map has doubled since the last sweep
+    std::unordered_map<std::uint64_t, std::unique_ptr<Chunk>> chunks_;
+    std::size_t sweep_at_ {0};
+    std::vector<glm::ivec2> grid_sizes_;
+
+    // the LOD each LOD's tiles are read from, itself unless it is derived
+    std::vector<unsigned> source_lods_;
+
+    // shared by every chunk, decoding is stateless. Tiles decode to YCbCr
+    // planes, converted to RGB when they are drawn
+    std::shared_ptr<ImageLoader> image_loader_;
+
+    // visible tiles of each LOD, empty for LODs that are not drawn
+    std::vector<TileRange> visible_ranges_;
+
+    // tiles last prefetched, kept while prefetching is paused, loads outside
+    // these and the visible range of the current LOD are cancelled
+    std::vector<TileRange> prefetch_ranges_;
+    std::vector<std::pair<Chunk*, TaskPriority>> prefetch_candidates_;
+    std::size_t prefetch_loads_ {0};
+
+    // chunks loading or waiting for an upload, the only ones visited besides
+    // the visible ranges so per-frame work doesn't grow with the pyramid
+    std::vector<Chunk*> pending_;
+
+    // the last GetVisibleTiles(), and how many of its entries are ancestors
+    std::vector<TileDraw> draws_ {};
+    std::size_t fallbacks_ {0};
+
+    std::shared_ptr<TileSource> source_ {nullptr};
+
+    // loads finished on loader threads, drained once per frame
+    std::shared_ptr<Chunk::Completions> completions_;
+
+    // ring of the latest load latencies, overwritten oldest first when full
+    std::vector<float> load_latencies_ {};
+    std::size_t next_latency_ {0};
+
+    // what tiles decode to, each layer of atlas_ holds one
+    PixelFormat format_ {PixelFormat::R8};
+    PixelLayout layout_ {PixelLayout::YCbCr420};
+    std::size_t tile_bytes_ {0};
+
+    TextureArray atlas_;
+
+    UploadRing staging_;
+
+    // loads still queued or running, they write into staging_ and call
+    // on_load, so the destructor waits for them
+    TaskGroup loads_;
+
+    ResidencyCache residency_;
+
+    UploadScheduler uploads_;
+
+    PrefetchParameters prefetch_;
 
     Bounds visible_bounds_ {};
     Dimensions image_dims_ {};
@@ -53,11 +206,69 @@ private:
     int lods_ {0};
     int max_lod_ {0};
 
-    auto GenerateChunks() -> void;
+    bool changed_ {false};
+
+    // the tile source and what is learned from it before the texture array
+    // is allocated
+    struct OpenedSource {
+        std::shared_ptr<TileSource> tiles {nullptr};
+        std::vector<bool> stored {};
+        PixelFormat format {PixelFormat::R8};
+        PixelLayout layout {PixelLayout::YCbCr420};
+    };
+
+    ChunkManager(const Parameters& params, RenderBackend& backend, OpenedSource opened);
+
+    static auto OpenSource(const Parameters& params, const std::vector<glm::ivec2>& grid_sizes) -> OpenedSource;
+
+    static auto ComputeGrids(Dimensions image_dims, int lods) -> std::vector<glm::ivec2>;
+
+    auto ComputeSourceLods(const std::vector<bool>& stored, int derive_above) -> void;
+
+    auto GetChunk(int lod, int x, int y) -> Chunk&;
+
+    auto SweepChunks() -> void;
+
+    // Null when no ancestor up to the base LOD is on the GPU.
+    auto FindResidentAncestor(const Chunk& chunk) const -> Chunk*;
+
+    // True for a coarser chunk over a visible tile of the current LOD that
+    // isn't on the GPU, it is drawn in that tile's place.
+    auto CoversMissingTile(const Chunk& chunk) const -> bool;
+
+    auto UploadPending() -> void;
+
+    auto ReleaseChunk(Chunk* chunk) -> void;
+
+    auto AddLoadLatency(const Chunk& chunk) -> void;
 
     auto ComputeLod(const OrthographicCamera& camera) const -> int;
 
-    auto IsChunkVisible(const Chunk& chunk) const -> bool;
+    auto UpdateVisibility() -> void;
+
+    auto Prefetch(const CameraMotion& motion) -> void;
+
+    auto ComputeTileRange(int lod, const Bounds& bounds) const -> TileRange;
+
+    static auto Expand(const TileRange& range, int margin, glm::ivec2 grid) -> TileRange;
+
+    static auto Union(const TileRange& a, const TileRange& b) -> TileRange;
+
+    static auto Contains(const TileRange& range, glm::ivec2 index) {
+        return glm::all(glm::greaterThanEqual(index, range.min)) &&
+               glm::all(glm::lessThan(index, range.max));
+    }
+
+    template <typename Callback>
+    auto ForEachChunk(int lod, const TileRange& range, Callback&& callback) -> void {
+        for (auto y = range.min.y; y < range.max.y; ++y) {
+            for (auto x = range.min.x; x < range.max.x; ++x) {
+                callback(GetChunk(lod, x, y));
+            }
+        }
+    }
+
+    auto LoadPriority(const Chunk& chunk) const -> TaskPriority;
 
     auto ComputeVisibleBounds(const OrthographicCamera& camera) const -> Bounds;
 };
\ No newline at end of file
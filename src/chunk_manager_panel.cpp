@@ -0,0 +1,64 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "chunk_manager_panel.h"
+
+#include "core/tracer.h"
+
+#include <iostream>
+
+#include <imgui.h>
+
+static constexpr auto kTraceFile = "tiling-trace.json";
+
+auto ChunkManagerPanel::Draw(ChunkManager& chunk_manager) -> void {
+    ImGui::SetNextWindowFocus();
+    ImGui::Begin("Chunk Manager");
+    ImGui::Text("Image dimensions: %dx%d", chunk_manager.image_dims_.width, chunk_manager.image_dims_.height);
+    ImGui::Text("Current LOD: %d", chunk_manager.curr_lod);
+    if (const auto source = chunk_manager.source_lods_[chunk_manager.curr_lod]; source != static_cast<unsigned>(chunk_manager.curr_lod)) {
+        ImGui::SameLine();
+        ImGui::Text("(decoded from LOD %u)", source);
+    }
+    ImGui::Separator();
+    ImGui::Checkbox("Show Wireframes", &chunk_manager.show_wireframes);
+    ImGui::Separator();
+    const auto stats = chunk_manager.residency_.GetStats();
+    ImGui::Text("Resident: %zu / %zu MB (%zu chunks)", stats.resident_bytes >> 20, stats.budget >> 20, stats.resident_chunks);
+    ImGui::Text("Evictions: %zu", stats.evictions);
+    ImGui::Separator();
+    const auto uploads = chunk_manager.uploads_.GetStats();
+    ImGui::SliderFloat("Upload budget (ms)", &chunk_manager.uploads_.params.time_budget_ms, 0.25f, 16.0f);
+    ImGui::SliderInt("Upload queue depth", &chunk_manager.uploads_.params.queue_depth, 1, 64);
+    ImGui::Text("Uploads: %zu this frame, %zu carried over", uploads.uploaded, uploads.pending);
+    ImGui::Text("Upload time: %.2f ms, %zu KB", uploads.upload_ms, uploads.uploaded_bytes >> 10);
+    ImGui::SliderFloat("Prefetch lookahead (s)", &chunk_manager.prefetch_.lookahead, 0.0f, 1.0f);
+    ImGui::Text("Prefetch loads: %zu", chunk_manager.prefetch_loads_);
+    ImGui::Text("Upload segments: %zu free, %zu in flight", chunk_manager.staging_.FreeSegments(), chunk_manager.staging_.InFlight());
+    ImGui::Text("Texture layers: %zu / %u", chunk_manager.atlas_.Layers() - chunk_manager.atlas_.FreeLayers(), chunk_manager.atlas_.Layers());
+    ImGui::Separator();
+    ImGui::Text("Chunks: %zu touched, %zu pending", chunk_manager.chunks_.size(), chunk_manager.pending_.size());
+    ImGui::Text("Drawn tiles: %zu, %zu from an ancestor", chunk_manager.draws_.size(), chunk_manager.fallbacks_);
+    auto& tracer = Tracer::Get();
+    auto tracing = tracer.IsEnabled();
+    if (ImGui::Checkbox("Trace tile loads", &tracing)) {
+        tracer.SetEnabled(tracing);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace")) {
+        if (auto saved = tracer.Save(kTraceFile); !saved) {
+            std::cerr << saved.error() << '\n';
+        }
+    }
+    // listing every chunk is only cheap for small pyramids, keep it collapsed
+    if (ImGui::CollapsingHeader("Chunks")) {
+        ImGui::Text(" V  L  ");
+        for (const auto& [_, chunk] : chunk_manager.chunks_) {
+            const auto visible = chunk->visible ? "X" : " ";
+            const auto loaded = chunk->State() == ChunkState::Loaded ? "X" : " ";
+            const auto index = chunk->GridIndex();
+            ImGui::Text("[%s][%s] LOD_%u_CHUNK_%d_%d", visible, loaded, chunk->Lod(), index.x, index.y);
+        }
+    }
+    ImGui::End();
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "chunk_manager.h"
+
+// Chunk manager state and tuning knobs in an ImGui window, kept out of the
+// chunk manager so the tile pipeline builds without ImGui.
+class ChunkManagerPanel {
+public:
+    auto Draw(ChunkManager& chunk_manager) -> void;
+};
\ No newline at end of file
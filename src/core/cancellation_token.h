@@ -0,0 +1,20 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <atomic>
+
+class CancellationToken {
+public:
+    auto Cancel() -> void {
+        cancelled_.store(true, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto IsCancelled() const -> bool {
+        return cancelled_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> cancelled_ {false};
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+
+// A lock-free queue any number of threads push to and one thread drains.
+// Producers link a node onto an atomic list with a CAS, the consumer takes
+// the whole list with a single exchange. Nodes are never popped one at a
+// time, so there is no ABA problem to guard against.
+template <typename T>
+class CompletionQueue {
+public:
+    // notify runs on the pushing thread after every push, e.g. to wake the
+    // consumer
+    explicit CompletionQueue(std::function<void()> notify = {}) :
+        notify_(std::move(notify)) {}
+
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    // Thread safe, the queue owns the value from here on.
+    auto Push(T value) -> void {
+        auto node = new Node {std::move(value), head_.load(std::memory_order_relaxed)};
+        // release publishes the value to the thread that drains it
+        while (!head_.compare_exchange_weak(
+            node->next, node,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        )) {}
+        if (notify_) notify_();
+    }
+
+    // Consumer only. Hands every value pushed so far to the callback, in
+    // push order per producer, and returns how many there were.
+    template <typename Callback>
+    auto Drain(Callback&& callback) -> std::size_t {
+        auto node = head_.exchange(nullptr, std::memory_order_acquire);
+
+        // the list is newest first
+        auto oldest = static_cast<Node*>(nullptr);
+        while (node) {
+            auto next = std::exchange(node->next, oldest);
+            oldest = node;
+            node = next;
+        }
+
+        auto count = std::size_t {0};
+        while (oldest) {
+            auto owned = std::unique_ptr<Node> {oldest};
+            oldest = owned->next;
+            callback(std::move(owned->value));
+            count++;
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto Empty() const {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    ~CompletionQueue() {
+        Drain([](T&&) {});
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_ {nullptr};
+
+    std::function<void()> notify_;
+};
\ No newline at end of file
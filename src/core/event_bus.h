@@ -0,0 +1,112 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "events.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// An event that can be folded into the one queued before it when that one
+// has the same type, so a burst of them is delivered once.
+template <typename T>
+concept CoalescedEvent = requires(T& event, const T& next) {
+    event.Merge(next);
+};
+
+// Typed events, queued by value in a fixed ring as they arrive and handed
+// to the listeners of their type by Flush(), once per frame. Publishing
+// never allocates, and runs of coalesced events collapse into one entry
+// while their order relative to other events is kept, so the cost per
+// frame stays flat however fast the input comes in. Main thread only.
+template <typename... Events>
+class EventBus {
+public:
+    // identifies a listener for Unsubscribe()
+    using Subscription = std::uint32_t;
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    static auto Get() -> EventBus& {
+        static auto instance = EventBus {};
+        return instance;
+    }
+
+    template <typename T> requires (std::is_same_v<T, Events> || ...)
+    auto Subscribe(std::function<void(const T&)> listener) -> Subscription {
+        std::get<Listeners<T>>(listeners_).emplace_back(next_subscription_, std::move(listener));
+        return next_subscription_++;
+    }
+
+    auto Unsubscribe(Subscription subscription) -> void {
+        const auto matches = [subscription](const auto& entry) {
+            return entry.first == subscription;
+        };
+        (std::erase_if(std::get<Listeners<Events>>(listeners_), matches), ...);
+    }
+
+    template <typename T> requires (std::is_same_v<T, Events> || ...)
+    auto Publish(const T& event) -> void {
+        if constexpr (CoalescedEvent<T>) {
+            if (size_ > 0) {
+                auto& last = queue_[(head_ + size_ - 1) % kCapacity];
+                if (auto queued = std::get_if<T>(&last)) {
+                    queued->Merge(event);
+                    return;
+                }
+            }
+        }
+
+        // delivering early keeps the order, nothing is dropped
+        if (size_ == kCapacity) Flush();
+        queue_[(head_ + size_) % kCapacity] = event;
+        size_++;
+    }
+
+    // Delivers the queued events in the order they were published.
+    auto Flush() -> void {
+        while (size_ > 0) {
+            // copied out, listeners may publish while it is delivered
+            const auto event = queue_[head_];
+            head_ = (head_ + 1) % kCapacity;
+            size_--;
+            std::visit([this](const auto& e) { Deliver(e); }, event);
+        }
+    }
+
+private:
+    static constexpr auto kCapacity = std::size_t {64};
+
+    template <typename T>
+    using Listeners = std::vector<std::pair<Subscription, std::function<void(const T&)>>>;
+
+    std::array<std::variant<Events...>, kCapacity> queue_ {};
+    std::size_t head_ {0};
+    std::size_t size_ {0};
+
+    std::tuple<Listeners<Events>...> listeners_ {};
+
+    Subscription next_subscription_ {0};
+
+    EventBus() = default;
+    ~EventBus() = default;
+
+    template <typename T>
+    auto Deliver(const T& event) -> void {
+        for (const auto& [_, listener] : std::get<Listeners<T>>(listeners_)) {
+            listener(event);
+        }
+    }
+};
+
+// mouse input from the window, flushed after events are polled each frame
+using InputBus = EventBus<MouseMoveEvent, MouseButtonEvent, MouseScrollEvent>;
\ No newline at end of file
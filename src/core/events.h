@@ -3,29 +3,8 @@
 
 #pragma once
 
-#include <type_traits>
-
 #include <glm/vec2.hpp>
 
-struct Event {
-    template<class T> requires std::is_base_of_v<Event, T>
-    [[nodiscard]] auto Is() const {
-        return dynamic_cast<const T*>(this) != nullptr;
-    }
-
-    template<class T> requires std::is_base_of_v<Event, T>
-    [[nodiscard]] auto As() {
-        return dynamic_cast<T*>(this);
-    }
-
-    template<class T> requires std::is_base_of_v<Event, T>
-    [[nodiscard]] auto As() const {
-        return dynamic_cast<const T*>(this);
-    }
-
-    virtual ~Event() = default;
-};
-
 enum class MouseButton {
     None,
     Left,
@@ -33,17 +12,27 @@ enum class MouseButton {
     Middle
 };
 
-struct MouseEvent : public Event {
-    enum class Type {
-        Moved,
-        ButtonPressed,
-        ButtonReleased,
-        Scrolled
-    };
+// Events are plain values. Those with a Merge() are coalesced by the event
+// bus, see CoalescedEvent.
+
+struct MouseMoveEvent {
+    glm::vec2 position {0.0f};
+
+    // only where the cursor ended up matters
+    auto Merge(const MouseMoveEvent& next) -> void {
+        position = next.position;
+    }
+};
+
+struct MouseButtonEvent {
+    MouseButton button {MouseButton::None};
+    bool pressed {false};
+};
 
-    glm::vec2 position;
-    glm::vec2 scroll;
+struct MouseScrollEvent {
+    glm::vec2 scroll {0.0f};
 
-    MouseEvent::Type type;
-    MouseButton button;
+    auto Merge(const MouseScrollEvent& next) -> void {
+        scroll += next.scroll;
+    }
 };
\ No newline at end of file
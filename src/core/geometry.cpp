@@ -50,6 +50,58 @@ auto Geometry::Draw(const Shaders& shader) const -> void {
     }
 }
 
+auto Geometry::SetInstanceBuffer(
+    unsigned int buffer,
+    std::size_t stride,
+    const std::vector<InstanceAttribute>& attributes
+) -> void {
+    instance_buffer_ = buffer;
+    instance_stride_ = stride;
+    instance_attributes_ = attributes;
+
+    glBindVertexArray(vao_);
+    for (const auto& attribute : instance_attributes_) {
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribDivisor(attribute.location, 1);
+    }
+    ConfigureInstances(0);
+    glBindVertexArray(0);
+}
+
+auto Geometry::DrawInstanced(const Shaders& shader, unsigned int count, unsigned int first) const -> void {
+    if (vao_ == 0 || instance_buffer_ == 0) {
+        std::cerr << "Geometry has no instance buffer. Cannot draw." << std::endl;
+        return;
+    }
+
+    shader.Use();
+    glBindVertexArray(vao_);
+    if (first != first_instance_) {
+        ConfigureInstances(first);
+    }
+    if (indices_size_ > 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, indices_size_, GL_UNSIGNED_INT, nullptr, count);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 3, count);
+    }
+}
+
+auto Geometry::ConfigureInstances(unsigned int first) const -> void {
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    for (const auto& attribute : instance_attributes_) {
+        const auto offset = attribute.offset + first * instance_stride_;
+        glVertexAttribPointer(
+            attribute.location,
+            attribute.size,
+            GL_FLOAT,
+            GL_FALSE,
+            static_cast<GLsizei>(instance_stride_),
+            reinterpret_cast<void*>(offset)
+        );
+    }
+    first_instance_ = first;
+}
+
 auto Geometry::ConfigureVertices(const std::vector<float>& vertex_data) -> void {
     glGenBuffers(1, &vbo_);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
@@ -3,10 +3,17 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "core/shaders.h"
 
+struct InstanceAttribute {
+    unsigned int location;
+    int size; // number of floats
+    std::size_t offset; // in bytes
+};
+
 class Geometry {
 public:
     Geometry(
@@ -16,6 +23,17 @@ public:
 
     auto Draw(const Shaders& shader) const -> void;
 
+    // Attaches a buffer of per-instance float attributes to the geometry.
+    auto SetInstanceBuffer(
+        unsigned int buffer,
+        std::size_t stride,
+        const std::vector<InstanceAttribute>& attributes
+    ) -> void;
+
+    // Draws count instances starting at first. GL 4.1 has no base instance,
+    // so the instance attributes are re-pointed when first changes.
+    auto DrawInstanced(const Shaders& shader, unsigned int count, unsigned int first = 0) const -> void;
+
 protected:
     Geometry() = default;
 
@@ -30,6 +48,12 @@ private:
     unsigned int ebo_ {0};
     unsigned int indices_size_ {0};
 
+    unsigned int instance_buffer_ {0};
+    std::size_t instance_stride_ {0};
+    std::vector<InstanceAttribute> instance_attributes_ {};
+    mutable unsigned int first_instance_ {0};
+
     auto ConfigureVertices(const std::vector<float>& vertex_data) -> void;
     auto ConfigureIndices(const std::vector<unsigned int>& index_data) -> void;
+    auto ConfigureInstances(unsigned int first) const -> void;
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/image.h"
+
+#include <array>
+
+#include <glad/glad.h>
+
+// The GL format of each pixel format and the swizzle that widens it to
+// RGBA, single channels read as gray and a second channel as alpha.
+struct GlFormat {
+    GLint internal_format;
+    GLenum format;
+    GLenum type;
+    std::array<GLint, 4> swizzle;
+};
+
+inline auto ToGlFormat(PixelFormat format) -> GlFormat {
+    switch (format) {
+        case PixelFormat::R8: return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, {GL_RED, GL_RED, GL_RED, GL_ONE}};
+        case PixelFormat::RG8: return {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, {GL_RED, GL_RED, GL_RED, GL_GREEN}};
+        case PixelFormat::RGB8: return {GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, {GL_RED, GL_GREEN, GL_BLUE, GL_ONE}};
+        case PixelFormat::RGBA8: break;
+        case PixelFormat::R16: return {GL_R16, GL_RED, GL_UNSIGNED_SHORT, {GL_RED, GL_RED, GL_RED, GL_ONE}};
+    }
+    return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}};
+}
\ No newline at end of file
@@ -0,0 +1,287 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "gl_render_backend.h"
+
+#include "shaders/headers/scene_frag.h"
+#include "shaders/headers/scene_vert.h"
+#include "shaders/headers/line_vert.h"
+#include "shaders/headers/line_frag.h"
+
+#include "core/gl_format.h"
+#include "core/image.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+GlRenderBackend::GlRenderBackend() :
+    geometry_({
+        .width = 1.0f,
+        .height = 1.0f,
+        .width_segments = 1,
+        .height_segments = 1
+    }),
+    shader_tile_({
+        {ShaderType::kVertexShader, _SHADER_scene_vert},
+        {ShaderType::kFragmentShader, _SHADER_scene_frag}
+    }),
+    shader_line_({
+        {ShaderType::kVertexShader, _SHADER_line_vert},
+        {ShaderType::kFragmentShader, _SHADER_line_frag}
+    })
+{
+    glGenBuffers(1, &instance_buffer_);
+    for (auto& timer : timer_queries_) {
+        glGenQueries(1, &timer.query);
+    }
+    geometry_.SetInstanceBuffer(instance_buffer_, sizeof(Instance), {
+        {.location = 3, .size = 4, .offset = offsetof(Instance, transform)},
+        {.location = 4, .size = 1, .offset = offsetof(Instance, layer)},
+        {.location = 5, .size = 4, .offset = offsetof(Instance, uv)}
+    });
+}
+
+auto GlRenderBackend::CreateTextureArray(
+    unsigned int width,
+    unsigned int height,
+    unsigned int layers,
+    PixelFormat format,
+    PixelLayout layout
+) -> unsigned int {
+    auto max_layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    const auto allocated = std::min(layers, static_cast<unsigned int>(max_layers));
+    if (allocated < layers) {
+        std::cerr << "Texture array clamped to " << allocated << " layers\n";
+    }
+
+    if (planes_ > 0) glDeleteTextures(static_cast<GLsizei>(planes_), textures_.data());
+    width_ = width;
+    height_ = height;
+    format_ = format;
+    layout_ = layout;
+
+    // rows of 1 to 3 byte samples aren't padded to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    const auto gl = ToGlFormat(format_);
+    const auto planes = Image::Planes(format_, layout_, width_, height_);
+    planes_ = static_cast<unsigned int>(planes.size());
+    glGenTextures(static_cast<GLsizei>(planes_), textures_.data());
+    for (auto plane = 0u; plane < planes_; ++plane) {
+        // chroma is filtered, that is its upsampling to the size of luma
+        const auto filter = plane == 0 ? GL_NEAREST : GL_LINEAR;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures_[plane]);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, gl.swizzle.data());
+        glTexImage3D(
+            GL_TEXTURE_2D_ARRAY,
+            0,
+            gl.internal_format,
+            static_cast<GLsizei>(planes[plane].stride / PixelBytes(format_)),
+            static_cast<GLsizei>(planes[plane].rows),
+            allocated,
+            0,
+            gl.format,
+            gl.type,
+            nullptr
+        );
+    }
+
+    return allocated;
+}
+
+auto GlRenderBackend::UploadLayer(unsigned int layer, const void* pixels) -> void {
+    // with an unpack buffer bound pixels is an offset into it, so the planes
+    // are found by adding to the address rather than through a pointer
+    const auto base = reinterpret_cast<std::uintptr_t>(pixels);
+    const auto gl = ToGlFormat(format_);
+    const auto planes = Image::Planes(format_, layout_, width_, height_);
+    for (auto plane = 0u; plane < planes.size(); ++plane) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures_[plane]);
+        glTexSubImage3D(
+            GL_TEXTURE_2D_ARRAY,
+            0,
+            0,
+            0,
+            layer,
+            static_cast<GLsizei>(planes[plane].stride / PixelBytes(format_)),
+            static_cast<GLsizei>(planes[plane].rows),
+            1,
+            gl.format,
+            gl.type,
+            reinterpret_cast<const void*>(base + planes[plane].offset)
+        );
+    }
+
+    stats_.uploads++;
+    stats_.upload_bytes += Image::Bytes(format_, layout_, width_, height_);
+}
+
+auto GlRenderBackend::CreateUploadSegments(std::size_t segment_bytes, unsigned int segments) -> void {
+    DeleteUploadSegments();
+    segment_bytes_ = segment_bytes;
+    segments_.resize(segments);
+    for (auto& segment : segments_) {
+        glGenBuffers(1, &segment.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, segment_bytes_, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+auto GlRenderBackend::MapUploadSegment(unsigned int index) -> std::byte* {
+    auto& segment = segments_[index];
+    if (segment.fence) {
+        glDeleteSync(segment.fence);
+        segment.fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+    // the previous copy has completed, nothing reads the old contents anymore
+    segment.mapped = static_cast<std::byte*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER,
+        0,
+        segment_bytes_,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    ));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (segment.mapped == nullptr) {
+        std::cerr << "Failed to map upload segment " << index << '\n';
+    }
+    return segment.mapped;
+}
+
+auto GlRenderBackend::CopyUploadSegment(unsigned int index, unsigned int layer) -> void {
+    auto& segment = segments_[index];
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    segment.mapped = nullptr;
+
+    // with an unpack buffer bound the pixel pointer is an offset into it
+    UploadLayer(layer, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+auto GlRenderBackend::IsUploadSegmentDone(unsigned int index) -> bool {
+    const auto fence = segments_[index].fence;
+    if (fence == nullptr) return true;
+    const auto status = glClientWaitSync(fence, 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+auto GlRenderBackend::UploadInstances(std::span<const Instance> instances) -> void {
+    // orphan the previous frame's storage instead of waiting on it
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    glBufferData(GL_ARRAY_BUFFER, instances.size_bytes(), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size_bytes(), instances.data());
+}
+
+auto GlRenderBackend::DrawTiles(
+    std::span<const Instance> instances,
+    const glm::mat4& projection,
+    const glm::mat4& view
+) -> void {
+    if (instances.empty()) return;
+
+    UploadInstances(instances);
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDisable(GL_BLEND);
+
+    shader_tile_.Use();
+    shader_tile_.SetUniform("u_Projection", projection);
+    shader_tile_.SetUniform("u_View", view);
+
+    shader_tile_.SetUniform("u_Luma", 0);
+    shader_tile_.SetUniform("u_ChromaBlue", 1);
+    shader_tile_.SetUniform("u_ChromaRed", 2);
+    shader_tile_.SetUniform("u_Planar", layout_ == PixelLayout::YCbCr420 ? 1 : 0);
+    for (auto plane = 0u; plane < planes_; ++plane) {
+        glActiveTexture(GL_TEXTURE0 + plane);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures_[plane]);
+        stats_.binds++;
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    geometry_.DrawInstanced(shader_tile_, static_cast<unsigned int>(instances.size()));
+    stats_.draw_calls++;
+    stats_.instances += instances.size();
+}
+
+auto GlRenderBackend::DrawWireframes(
+    std::span<const Instance> instances,
+    const glm::mat4& projection,
+    const glm::mat4& view
+) -> void {
+    if (instances.empty()) return;
+
+    UploadInstances(instances);
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader_line_.Use();
+    shader_line_.SetUniform("u_Projection", projection);
+    shader_line_.SetUniform("u_View", view);
+
+    geometry_.DrawInstanced(shader_line_, static_cast<unsigned int>(instances.size()));
+    stats_.draw_calls++;
+    stats_.instances += instances.size();
+}
+
+auto GlRenderBackend::DeleteUploadSegments() -> void {
+    for (auto& segment : segments_) {
+        if (segment.fence) glDeleteSync(segment.fence);
+        if (segment.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glDeleteBuffers(1, &segment.buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    segments_.clear();
+}
+
+auto GlRenderBackend::BeginGpuTimer() -> void {
+    auto& timer = timer_queries_[timer_frame_++ % timer_queries_.size()];
+    if (timer.issued) {
+        auto available = GLint {0};
+        glGetQueryObjectiv(timer.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+
+        auto elapsed = GLuint64 {0};
+        glGetQueryObjectui64v(timer.query, GL_QUERY_RESULT, &elapsed);
+        gpu_ms_ = static_cast<float>(elapsed) / 1e6f;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, timer.query);
+    timer.issued = true;
+    timing_ = true;
+}
+
+auto GlRenderBackend::EndGpuTimer() -> void {
+    if (!timing_) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    timing_ = false;
+}
+
+GlRenderBackend::~GlRenderBackend() {
+    for (auto& timer : timer_queries_) {
+        glDeleteQueries(1, &timer.query);
+    }
+    DeleteUploadSegments();
+    glDeleteTextures(static_cast<GLsizei>(planes_), textures_.data());
+    glDeleteBuffers(1, &instance_buffer_);
+}
\ No newline at end of file
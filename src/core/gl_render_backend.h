@@ -0,0 +1,106 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/render_backend.h"
+#include "core/shaders.h"
+#include "geometries/plane_geometry.h"
+
+#include <array>
+#include <vector>
+
+// matches the GLsync handle without pulling GL into the header
+using GLsyncHandle = struct __GLsync*;
+
+// Needs a current GL context for its whole lifetime.
+class GlRenderBackend : public RenderBackend {
+public:
+    GlRenderBackend();
+
+    GlRenderBackend(const GlRenderBackend&) = delete;
+    GlRenderBackend& operator=(const GlRenderBackend&) = delete;
+
+    auto CreateTextureArray(
+        unsigned int width,
+        unsigned int height,
+        unsigned int layers,
+        PixelFormat format,
+        PixelLayout layout
+    ) -> unsigned int override;
+
+    auto UploadLayer(unsigned int layer, const void* pixels) -> void override;
+
+    auto CreateUploadSegments(std::size_t segment_bytes, unsigned int segments) -> void override;
+
+    auto MapUploadSegment(unsigned int segment) -> std::byte* override;
+
+    auto CopyUploadSegment(unsigned int segment, unsigned int layer) -> void override;
+
+    auto IsUploadSegmentDone(unsigned int segment) -> bool override;
+
+    auto DrawTiles(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void override;
+
+    auto DrawWireframes(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void override;
+
+    auto BeginGpuTimer() -> void override;
+
+    auto EndGpuTimer() -> void override;
+
+    [[nodiscard]] auto GpuMilliseconds() const -> float override {
+        return gpu_ms_;
+    }
+
+    ~GlRenderBackend() override;
+
+private:
+    // GL 4.1 has no persistent mapping, so each segment is its own buffer
+    // and only the one being copied is unmapped
+    struct Segment {
+        unsigned int buffer {0};
+        std::byte* mapped {nullptr};
+        GLsyncHandle fence {nullptr};
+    };
+
+    PlaneGeometry geometry_;
+
+    Shaders shader_tile_;
+    Shaders shader_line_;
+
+    unsigned int instance_buffer_ {0};
+
+    // one texture per plane of the tiles, a tile has the same layer in each:
+    // Y, Cb and Cr for YCbCr planes, otherwise just the first
+    std::array<unsigned int, 3> textures_ {};
+    unsigned int planes_ {0};
+    unsigned int width_ {0};
+    unsigned int height_ {0};
+    PixelFormat format_ {PixelFormat::R8};
+    PixelLayout layout_ {PixelLayout::YCbCr420};
+
+    std::vector<Segment> segments_ {};
+    std::size_t segment_bytes_ {0};
+
+    // GL_TIME_ELAPSED queries read back frames later so they never stall,
+    // a frame whose query is still in flight goes untimed
+    struct TimerQuery {
+        unsigned int query {0};
+        bool issued {false};
+    };
+    std::array<TimerQuery, 4> timer_queries_ {};
+    std::size_t timer_frame_ {0};
+    bool timing_ {false};
+    float gpu_ms_ {0.0f};
+
+    auto UploadInstances(std::span<const Instance> instances) -> void;
+
+    auto DeleteUploadSegments() -> void;
+};
\ No newline at end of file
@@ -3,12 +3,58 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 using ImageData = std::unique_ptr<unsigned char[], std::function<void(void*)>>;
 
+// The channels of a pixel, or of a sample in a planar layout, 8 or 16 bits
+// per channel. Shaders see all of them as RGBA, see ToGlFormat().
+enum class PixelFormat {
+    R8,
+    RG8,
+    RGB8,
+    RGBA8,
+    R16
+};
+
+[[nodiscard]] constexpr auto PixelChannels(PixelFormat format) -> unsigned int {
+    switch (format) {
+        case PixelFormat::R8: return 1;
+        case PixelFormat::RG8: return 2;
+        case PixelFormat::RGB8: return 3;
+        case PixelFormat::RGBA8: return 4;
+        case PixelFormat::R16: return 1;
+    }
+    return 0;
+}
+
+[[nodiscard]] constexpr auto PixelBytes(PixelFormat format) -> unsigned int {
+    return format == PixelFormat::R16 ? 2 : PixelChannels(format);
+}
+
+// The 8-bit format with the given number of channels, 1 to 4.
+[[nodiscard]] constexpr auto PixelFormatOf(int channels) -> PixelFormat {
+    switch (channels) {
+        case 1: return PixelFormat::R8;
+        case 2: return PixelFormat::RG8;
+        case 3: return PixelFormat::RGB8;
+        default: return PixelFormat::RGBA8;
+    }
+}
+
+// How the pixels are laid out in memory.
+enum class PixelLayout {
+    // one plane of whole pixels
+    Interleaved,
+    // JPEG's own YCbCr planes, one sample per pixel each: Y at full size,
+    // then Cb and Cr at half the width and height
+    YCbCr420
+};
+
 class Image {
 public:
     struct Parameters {
@@ -16,19 +62,34 @@ public:
         int width {0};
         int height {0};
         int depth {0};
+        PixelFormat format {PixelFormat::RGBA8};
+        PixelLayout layout {PixelLayout::Interleaved};
+    };
+
+    // Where a plane starts in the data, its bytes per row and its rows.
+    struct Plane {
+        std::size_t offset;
+        std::size_t stride;
+        unsigned int rows;
     };
 
     std::string filename {};
 
     unsigned int width {0};
     unsigned int height {0};
+    // channels of the source, format and layout decide what is in memory
     unsigned int depth {0};
 
+    PixelFormat format {PixelFormat::RGBA8};
+    PixelLayout layout {PixelLayout::Interleaved};
+
     Image(const Parameters& params, ImageData data) :
         filename(params.filename),
         width(params.width),
         height(params.height),
         depth(params.depth),
+        format(params.format),
+        layout(params.layout),
         data_(std::move(data)) {}
 
     Image(Image&& other) noexcept :
@@ -36,6 +97,8 @@ public:
         width(other.width),
         height(other.height),
         depth(other.depth),
+        format(other.format),
+        layout(other.layout),
         data_(std::move(other.data_))
     {
         Reset(other);
@@ -48,6 +111,8 @@ public:
             width = other.width;
             height = other.height;
             depth = other.depth;
+            format = other.format;
+            layout = other.layout;
             Reset(other);
         }
         return *this;
@@ -59,6 +124,40 @@ public:
 
     [[nodiscard]] auto Data() const { return data_.get(); }
 
+    [[nodiscard]] static auto Planes(
+        PixelFormat format,
+        PixelLayout layout,
+        unsigned int width,
+        unsigned int height
+    ) {
+        const auto bytes = static_cast<std::size_t>(PixelBytes(format));
+        if (layout == PixelLayout::Interleaved) {
+            return std::vector<Plane> {{0, width * bytes, height}};
+        }
+        const auto luma = width * bytes * height;
+        const auto chroma_stride = (width + 1) / 2 * bytes;
+        const auto chroma_height = (height + 1) / 2;
+        return std::vector<Plane> {
+            {0, width * bytes, height},
+            {luma, chroma_stride, chroma_height},
+            {luma + chroma_stride * chroma_height, chroma_stride, chroma_height}
+        };
+    }
+
+    [[nodiscard]] static auto Bytes(
+        PixelFormat format,
+        PixelLayout layout,
+        unsigned int width,
+        unsigned int height
+    ) {
+        const auto last = Planes(format, layout, width, height).back();
+        return last.offset + last.stride * last.rows;
+    }
+
+    [[nodiscard]] auto Planes() const { return Planes(format, layout, width, height); }
+
+    [[nodiscard]] auto Bytes() const { return Bytes(format, layout, width, height); }
+
     ~Image() = default;
 
 private:
@@ -70,5 +169,7 @@ private:
         instance.width = 0;
         instance.height = 0;
         instance.depth = 0;
+        instance.format = PixelFormat::RGBA8;
+        instance.layout = PixelLayout::Interleaved;
     }
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "null_render_backend.h"
+
+#include "core/image.h"
+
+auto NullRenderBackend::CreateTextureArray(
+    unsigned int width,
+    unsigned int height,
+    unsigned int layers,
+    PixelFormat format,
+    PixelLayout layout
+) -> unsigned int {
+    layer_bytes_ = Image::Bytes(format, layout, width, height);
+    return layers;
+}
+
+auto NullRenderBackend::UploadLayer(unsigned int, const void*) -> void {
+    stats_.uploads++;
+    stats_.upload_bytes += layer_bytes_;
+}
+
+auto NullRenderBackend::CreateUploadSegments(std::size_t segment_bytes, unsigned int segments) -> void {
+    segments_.assign(segments, std::vector<std::byte>(segment_bytes));
+}
+
+auto NullRenderBackend::MapUploadSegment(unsigned int segment) -> std::byte* {
+    return segments_[segment].data();
+}
+
+auto NullRenderBackend::CopyUploadSegment(unsigned int segment, unsigned int layer) -> void {
+    UploadLayer(layer, segments_[segment].data());
+}
+
+auto NullRenderBackend::DrawTiles(
+    std::span<const Instance> instances,
+    const glm::mat4&,
+    const glm::mat4&
+) -> void {
+    if (instances.empty()) return;
+    // one per plane, as in the GL backend
+    stats_.binds += 3;
+    stats_.draw_calls++;
+    stats_.instances += instances.size();
+}
+
+auto NullRenderBackend::DrawWireframes(
+    std::span<const Instance> instances,
+    const glm::mat4&,
+    const glm::mat4&
+) -> void {
+    if (instances.empty()) return;
+    stats_.draw_calls++;
+    stats_.instances += instances.size();
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/render_backend.h"
+
+#include <cstddef>
+#include <vector>
+
+// Records what would be sent to the GPU without a context or a display.
+// Upload segments are plain memory and copies complete immediately.
+class NullRenderBackend : public RenderBackend {
+public:
+    auto CreateTextureArray(
+        unsigned int width,
+        unsigned int height,
+        unsigned int layers,
+        PixelFormat format,
+        PixelLayout layout
+    ) -> unsigned int override;
+
+    auto UploadLayer(unsigned int layer, const void* pixels) -> void override;
+
+    auto CreateUploadSegments(std::size_t segment_bytes, unsigned int segments) -> void override;
+
+    auto MapUploadSegment(unsigned int segment) -> std::byte* override;
+
+    auto CopyUploadSegment(unsigned int segment, unsigned int layer) -> void override;
+
+    auto IsUploadSegmentDone(unsigned int) -> bool override { return true; }
+
+    auto DrawTiles(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void override;
+
+    auto DrawWireframes(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void override;
+
+    auto BeginGpuTimer() -> void override {}
+
+    auto EndGpuTimer() -> void override {}
+
+    [[nodiscard]] auto GpuMilliseconds() const -> float override { return 0.0f; }
+
+private:
+    std::size_t layer_bytes_ {0};
+
+    std::vector<std::vector<std::byte>> segments_ {};
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/image.h"
+
+#include <cstddef>
+#include <span>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// The graphics calls the tile pipeline makes: texture array layers of
+// equally sized tiles in the format of the pyramid, a set of staging
+// segments to upload them from, and instanced draws of a unit quad.
+// Everything above this interface runs the same with the GL backend and
+// with a null backend in headless runs.
+class RenderBackend {
+public:
+    struct Instance {
+        glm::vec4 transform; // xy centre, zw size
+        glm::vec4 uv; // xy offset, zw scale of the texture coordinates
+        float layer;
+    };
+
+    struct Stats {
+        std::size_t uploads {0};
+        std::size_t upload_bytes {0};
+        std::size_t binds {0};
+        std::size_t draw_calls {0};
+        std::size_t instances {0};
+    };
+
+    // Returns the number of layers actually allocated. Layers are width x
+    // height images in format and layout, e.g. YCbCr planes for colour
+    // pyramids and a single R8 or R16 plane for grayscale ones.
+    virtual auto CreateTextureArray(
+        unsigned int width,
+        unsigned int height,
+        unsigned int layers,
+        PixelFormat format,
+        PixelLayout layout
+    ) -> unsigned int = 0;
+
+    // pixels holds a layer's image, its planes back to back.
+    virtual auto UploadLayer(unsigned int layer, const void* pixels) -> void = 0;
+
+    virtual auto CreateUploadSegments(std::size_t segment_bytes, unsigned int segments) -> void = 0;
+
+    // Memory another thread may fill, null if the segment can't be mapped.
+    virtual auto MapUploadSegment(unsigned int segment) -> std::byte* = 0;
+
+    // Unmaps a filled segment and copies it into a layer.
+    virtual auto CopyUploadSegment(unsigned int segment, unsigned int layer) -> void = 0;
+
+    // True once the last copy out of the segment has completed.
+    virtual auto IsUploadSegmentDone(unsigned int segment) -> bool = 0;
+
+    virtual auto DrawTiles(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void = 0;
+
+    virtual auto DrawWireframes(
+        std::span<const Instance> instances,
+        const glm::mat4& projection,
+        const glm::mat4& view
+    ) -> void = 0;
+
+    // Brackets the GPU work of a frame, results arrive a few frames late.
+    virtual auto BeginGpuTimer() -> void = 0;
+
+    virtual auto EndGpuTimer() -> void = 0;
+
+    // GPU time of the latest timed frame with a result, 0 until there is one.
+    [[nodiscard]] virtual auto GpuMilliseconds() const -> float = 0;
+
+    [[nodiscard]] auto GetStats() const { return stats_; }
+
+    auto ResetStats() { stats_ = {}; }
+
+    virtual ~RenderBackend() = default;
+
+protected:
+    Stats stats_ {};
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+// Counts tasks handed to the thread pool so their owner can wait for them
+// before it destroys what they point at. A task holds a handle from Track(),
+// it is done once every copy of the handle is gone, whether the task ran or
+// was dropped from the queue after a cancel.
+class TaskGroup {
+public:
+    TaskGroup() = default;
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    [[nodiscard]] auto Track() -> std::shared_ptr<void> {
+        {
+            auto lock = std::scoped_lock {mutex_};
+            count_++;
+        }
+        return std::shared_ptr<void>(static_cast<void*>(this), [this](void*) {
+            // notified under the lock, Wait() may return and the group go
+            // away as soon as it is released
+            auto lock = std::scoped_lock {mutex_};
+            count_--;
+            done_.notify_all();
+        });
+    }
+
+    // Blocks until every tracked task is done.
+    auto Wait() -> void {
+        auto lock = std::unique_lock {mutex_};
+        done_.wait(lock, [this] { return count_ == 0; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::size_t count_ {0};
+};
\ No newline at end of file
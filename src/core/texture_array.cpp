@@ -0,0 +1,48 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "texture_array.h"
+
+#include <iostream>
+
+TextureArray::TextureArray(RenderBackend& backend, const Parameters& params) :
+    backend_(backend),
+    width_(params.width),
+    height_(params.height),
+    format_(params.format),
+    layout_(params.layout)
+{
+    layers_ = backend_.CreateTextureArray(width_, height_, params.layers, format_, layout_);
+
+    // hand out low layers first
+    free_.reserve(layers_);
+    for (auto layer = layers_; layer > 0; --layer) {
+        free_.emplace_back(layer - 1);
+    }
+}
+
+auto TextureArray::Acquire() -> std::optional<unsigned int> {
+    if (free_.empty()) return std::nullopt;
+    const auto layer = free_.back();
+    free_.pop_back();
+    return layer;
+}
+
+auto TextureArray::Release(unsigned int layer) -> void {
+    free_.emplace_back(layer);
+}
+
+auto TextureArray::Upload(unsigned int layer, const Image& image) -> bool {
+    if (image.width != width_ || image.height != height_) {
+        std::cerr << "Image '" << image.filename << "' does not match the texture array size\n";
+        return false;
+    }
+    if (image.format != format_ || image.layout != layout_) {
+        std::cerr << "Image '" << image.filename << "' does not match the texture array format\n";
+        return false;
+    }
+
+    backend_.UploadLayer(layer, image.Data());
+
+    return true;
+}
\ No newline at end of file
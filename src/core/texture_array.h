@@ -0,0 +1,57 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/image.h"
+#include "core/render_backend.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// The backend's texture array of fixed-size layers, handed out as slots.
+// Storage is allocated once, so reusing a slot is a sub-image upload into
+// memory the driver already owns instead of a texture create and delete.
+class TextureArray {
+public:
+    struct Parameters {
+        unsigned int width {0};
+        unsigned int height {0};
+        unsigned int layers {0};
+        PixelFormat format {PixelFormat::R8};
+        PixelLayout layout {PixelLayout::YCbCr420};
+    };
+
+    TextureArray(RenderBackend& backend, const Parameters& params);
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    [[nodiscard]] auto Acquire() -> std::optional<unsigned int>;
+
+    auto Release(unsigned int layer) -> void;
+
+    // The image must match the layer size, format and layout, returns false
+    // if it does not.
+    auto Upload(unsigned int layer, const Image& image) -> bool;
+
+    [[nodiscard]] auto Layers() const { return layers_; }
+
+    [[nodiscard]] auto FreeLayers() const { return free_.size(); }
+
+    [[nodiscard]] auto LayerBytes() const {
+        return Image::Bytes(format_, layout_, width_, height_);
+    }
+
+private:
+    RenderBackend& backend_;
+
+    unsigned int width_ {0};
+    unsigned int height_ {0};
+    unsigned int layers_ {0};
+    PixelFormat format_ {PixelFormat::R8};
+    PixelLayout layout_ {PixelLayout::YCbCr420};
+
+    std::vector<unsigned int> free_ {};
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+static constexpr auto kDefaultBytesInFlight = std::size_t {64} << 20;
+
+// heap comparator, the job with the lowest priority value (and then the
+// oldest one) ends up at the front of the queue
+static auto RunsAfter = [](const auto& a, const auto& b) {
+    if (a.priority != b.priority) return b.priority < a.priority;
+    return b.sequence < a.sequence;
+};
+
+ThreadPool::ThreadPool(const Parameters& params) :
+    max_bytes_in_flight_(params.max_bytes_in_flight)
+{
+    const auto threads = std::max(params.threads, 1u);
+    workers_.reserve(threads);
+    for (auto i = 0u; i < threads; ++i) {
+        workers_.emplace_back([this](std::stop_token stop_token) {
+            Worker(stop_token);
+        });
+    }
+}
+
+auto ThreadPool::Get() -> ThreadPool& {
+    // leave one core for the render thread
+    static auto instance = ThreadPool {{
+        .threads = std::max(std::thread::hardware_concurrency(), 2u) - 1,
+        .max_bytes_in_flight = kDefaultBytesInFlight
+    }};
+    return instance;
+}
+
+auto ThreadPool::Submit(
+    Task task,
+    const TaskPriority& priority,
+    std::size_t bytes,
+    std::shared_ptr<CancellationToken> token
+) -> void {
+    {
+        auto lock = std::scoped_lock {mutex_};
+        queue_.emplace_back(Job {
+            .task = std::move(task),
+            .priority = priority,
+            .bytes = bytes,
+            .sequence = sequence_++,
+            .token = std::move(token)
+        });
+        std::ranges::push_heap(queue_, RunsAfter);
+    }
+    condition_.notify_one();
+}
+
+auto ThreadPool::Reprioritize(
+    const std::shared_ptr<CancellationToken>& token,
+    const TaskPriority& priority
+) -> void {
+    if (token == nullptr) return;
+    auto lock = std::scoped_lock {mutex_};
+    reprioritized_[token] = priority;
+}
+
+auto ThreadPool::PurgeCancelled() -> void {
+    auto lock = std::scoped_lock {mutex_};
+    PurgeCancelledLocked();
+}
+
+auto ThreadPool::QueueSize() -> std::size_t {
+    auto lock = std::scoped_lock {mutex_};
+    PurgeCancelledLocked();
+    return queue_.size();
+}
+
+auto ThreadPool::BytesInFlight() const -> std::size_t {
+    auto lock = std::scoped_lock {mutex_};
+    return bytes_in_flight_;
+}
+
+auto ThreadPool::CanStart(const Job& job) const -> bool {
+    if (max_bytes_in_flight_ == 0 || bytes_in_flight_ == 0) return true;
+    return bytes_in_flight_ + job.bytes <= max_bytes_in_flight_;
+}
+
+auto ThreadPool::DropCancelled() -> void {
+    while (!queue_.empty()) {
+        const auto& token = queue_.front().token;
+        if (token == nullptr || !token->IsCancelled()) return;
+        std::ranges::pop_heap(queue_, RunsAfter);
+        queue_.pop_back();
+    }
+}
+
+auto ThreadPool::PurgeCancelledLocked() -> void {
+    // DropCancelled only sees the front of the heap
+    const auto dropped = std::erase_if(queue_, [](const Job& job) {
+        return job.token != nullptr && job.token->IsCancelled();
+    });
+    if (dropped > 0) std::ranges::make_heap(queue_, RunsAfter);
+}
+
+auto ThreadPool::ApplyPriorities() -> void {
+    if (reprioritized_.empty()) return;
+
+    // one pass and one heap rebuild for every move since the last task
+    auto changed = false;
+    for (auto& job : queue_) {
+        if (job.token == nullptr) continue;
+        auto moved = reprioritized_.find(job.token);
+        if (moved == end(reprioritized_) || moved->second == job.priority) continue;
+        job.priority = moved->second;
+        changed = true;
+    }
+    reprioritized_.clear();
+    if (changed) std::ranges::make_heap(queue_, RunsAfter);
+}
+
+auto ThreadPool::Worker(std::stop_token stop_token) -> void {
+    while (true) {
+        auto lock = std::unique_lock {mutex_};
+        const auto ready = condition_.wait(lock, stop_token, [this] {
+            ApplyPriorities();
+            DropCancelled();
+            return !queue_.empty() && CanStart(queue_.front());
+        });
+        if (!ready) return;
+
+        std::ranges::pop_heap(queue_, RunsAfter);
+        auto job = std::move(queue_.back());
+        queue_.pop_back();
+        bytes_in_flight_ += job.bytes;
+        lock.unlock();
+
+        job.task();
+
+        lock.lock();
+        bytes_in_flight_ -= job.bytes;
+        lock.unlock();
+
+        // a finished job may unblock more than one job waiting on the budget
+        condition_.notify_all();
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        auto lock = std::scoped_lock {mutex_};
+        queue_.clear();
+        reprioritized_.clear();
+    }
+    for (auto& worker : workers_) {
+        worker.request_stop();
+    }
+    // join before the mutex and condition variable go out of scope
+    workers_.clear();
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <compare>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/cancellation_token.h"
+
+struct TaskPriority {
+    // coarse ordering, lower runs first (e.g. distance from the current LOD)
+    int level {0};
+    // fine ordering within a level (e.g. distance to the viewport centre)
+    float distance {0.0f};
+
+    auto operator<=>(const TaskPriority&) const = default;
+};
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    struct Parameters {
+        unsigned int threads {1};
+        std::size_t max_bytes_in_flight {0};
+    };
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    explicit ThreadPool(const Parameters& params);
+
+    static auto Get() -> ThreadPool&;
+
+    // bytes is the estimated memory the task holds while it runs. Tasks only
+    // start while the total stays under the budget, a single task larger than
+    // the budget is still allowed to run on its own.
+    // Queued tasks whose token has been cancelled are dropped without running.
+    auto Submit(
+        Task task,
+        const TaskPriority& priority = {},
+        std::size_t bytes = 0,
+        std::shared_ptr<CancellationToken> token = nullptr
+    ) -> void;
+
+    // Moves a queued task to a new position, no-op if it already started.
+    // Moves are batched and applied when a worker next takes a task.
+    auto Reprioritize(const std::shared_ptr<CancellationToken>& token, const TaskPriority& priority) -> void;
+
+    // Drops every queued task whose token has been cancelled.
+    auto PurgeCancelled() -> void;
+
+    // Tasks waiting to run, cancelled ones are purged first.
+    [[nodiscard]] auto QueueSize() -> std::size_t;
+
+    [[nodiscard]] auto BytesInFlight() const -> std::size_t;
+
+    ~ThreadPool();
+
+private:
+    struct Job {
+        Task task;
+        TaskPriority priority;
+        std::size_t bytes;
+        std::uint64_t sequence;
+        std::shared_ptr<CancellationToken> token;
+    };
+
+    std::vector<Job> queue_;
+    std::unordered_map<std::shared_ptr<CancellationToken>, TaskPriority> reprioritized_;
+    std::vector<std::jthread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any condition_;
+
+    std::size_t max_bytes_in_flight_ {0};
+    std::size_t bytes_in_flight_ {0};
+    std::uint64_t sequence_ {0};
+
+    auto Worker(std::stop_token stop_token) -> void;
+
+    auto CanStart(const Job& job) const -> bool;
+
+    auto DropCancelled() -> void;
+
+    auto PurgeCancelledLocked() -> void;
+
+    auto ApplyPriorities() -> void;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "tracer.h"
+
+#include <format>
+#include <fstream>
+
+// 2 MB per thread that records anything
+static constexpr auto kEventsPerThread = std::size_t {1} << 16;
+
+auto Tracer::Get() -> Tracer& {
+    static auto instance = Tracer {};
+    return instance;
+}
+
+auto Tracer::Record(const char* name, std::uint64_t id, std::int64_t begin, std::int64_t end) -> void {
+    if (!IsEnabled()) return;
+
+    auto& buffer = ThreadBuffer();
+    const auto size = buffer.size.load(std::memory_order_relaxed);
+    if (size == kEventsPerThread) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[size] = {name, id, begin, end};
+    // publishes the event to Save()
+    buffer.size.store(size + 1, std::memory_order_release);
+}
+
+auto Tracer::ThreadBuffer() -> Buffer& {
+    thread_local Buffer* buffer = nullptr;
+    if (buffer) return *buffer;
+
+    // buffers outlive their threads, a pool worker may exit before saving
+    auto lock = std::scoped_lock {mutex_};
+    auto& added = buffers_.emplace_back(std::make_unique<Buffer>());
+    added->events = std::make_unique<Event[]>(kEventsPerThread);
+    added->thread = static_cast<unsigned int>(buffers_.size() - 1);
+    buffer = added.get();
+    return *buffer;
+}
+
+auto Tracer::Save(const fs::path& path) const -> std::expected<void, std::string> {
+    auto file = std::ofstream {path, std::ios::trunc};
+    if (!file) {
+        return std::unexpected(std::format("Failed to open trace file '{}'", path.string()));
+    }
+
+    auto lock = std::scoped_lock {mutex_};
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    auto first = true;
+    auto write = [&](const std::string& event) {
+        file << (first ? "" : ",\n") << event;
+        first = false;
+    };
+
+    for (const auto& buffer : buffers_) {
+        write(std::format(
+            R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"thread {}"}}}})",
+            buffer->thread, buffer->thread
+        ));
+
+        // async events, grouped into one track per id across threads
+        const auto size = buffer->size.load(std::memory_order_acquire);
+        for (auto i = std::size_t {0}; i < size; ++i) {
+            const auto& event = buffer->events[i];
+            auto add = [&](char phase, std::int64_t time) {
+                write(std::format(
+                    R"({{"name":"{}","cat":"tiling","ph":"{}","id":"{:#x}","pid":1,"tid":{},"ts":{:.3f}}})",
+                    event.name, phase, event.id, buffer->thread, static_cast<double>(time) / 1000.0
+                ));
+            };
+            if (event.begin == event.end) {
+                add('n', event.begin);
+            } else {
+                add('b', event.begin);
+                add('e', event.end);
+            }
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        return std::unexpected(std::format("Failed to write trace file '{}'", path.string()));
+    }
+    return {};
+}
+
+auto Tracer::Dropped() const -> std::size_t {
+    auto lock = std::scoped_lock {mutex_};
+    auto dropped = std::size_t {0};
+    for (const auto& buffer : buffers_) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
\ No newline at end of file
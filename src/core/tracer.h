@@ -0,0 +1,88 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Timestamps the steps of work tied to an id (e.g. a tile key) and saves
+// them as a Chrome trace, chrome://tracing and Perfetto show one track per id.
+// Every thread appends to its own buffer without taking a lock. A full buffer
+// drops the events of its thread, they are counted in Dropped().
+class Tracer {
+public:
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static auto Get() -> Tracer&;
+
+    // Off by default, a disabled Record() is a single relaxed load.
+    auto SetEnabled(bool enabled) -> void {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto IsEnabled() const -> bool {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Nanoseconds since the tracer was created.
+    [[nodiscard]] auto Now() const -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_
+        ).count();
+    }
+
+    // The name is stored as a pointer, pass a string literal. An event that
+    // begins and ends at the same time is an instant.
+    auto Record(const char* name, std::uint64_t id, std::int64_t begin, std::int64_t end) -> void;
+
+    auto Record(const char* name, std::uint64_t id) -> void {
+        if (!IsEnabled()) return;
+        const auto now = Now();
+        Record(name, id, now, now);
+    }
+
+    // Writes every event recorded so far, other threads may keep recording.
+    auto Save(const fs::path& path) const -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto Dropped() const -> std::size_t;
+
+private:
+    struct Event {
+        const char* name;
+        std::uint64_t id;
+        std::int64_t begin;
+        std::int64_t end;
+    };
+
+    // written by its thread only, events below size are never modified again
+    struct Buffer {
+        std::unique_ptr<Event[]> events;
+        std::atomic<std::size_t> size {0};
+        std::atomic<std::size_t> dropped {0};
+        unsigned int thread {0};
+    };
+
+    Tracer() : start_(std::chrono::steady_clock::now()) {}
+
+    std::chrono::steady_clock::time_point start_;
+
+    std::atomic<bool> enabled_ {false};
+
+    // taken when a thread records its first event and when saving
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+    auto ThreadBuffer() -> Buffer&;
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "upload_ring.h"
+
+UploadRing::UploadRing(RenderBackend& backend, const Parameters& params) :
+    backend_(backend),
+    mapped_(params.segments, nullptr),
+    segment_bytes_(params.segment_bytes)
+{
+    backend_.CreateUploadSegments(segment_bytes_, params.segments);
+    for (auto i = 0u; i < params.segments; ++i) {
+        if (Map(i)) free_.emplace_back(i);
+    }
+}
+
+auto UploadRing::Map(unsigned int segment) -> bool {
+    mapped_[segment] = backend_.MapUploadSegment(segment);
+    return mapped_[segment] != nullptr;
+}
+
+auto UploadRing::TryAcquire() -> std::optional<Staging> {
+    auto lock = std::lock_guard {mutex_};
+    if (free_.empty()) return std::nullopt;
+    const auto segment = free_.back();
+    free_.pop_back();
+    return Staging {segment, {mapped_[segment], segment_bytes_}};
+}
+
+auto UploadRing::Discard(unsigned int segment) -> void {
+    auto lock = std::lock_guard {mutex_};
+    free_.emplace_back(segment);
+}
+
+auto UploadRing::CopyTo(unsigned int segment, unsigned int layer) -> void {
+    backend_.CopyUploadSegment(segment, layer);
+    mapped_[segment] = nullptr;
+    in_flight_.emplace_back(segment);
+}
+
+auto UploadRing::Reclaim() -> void {
+    // copies complete in submission order, stop at the first pending one
+    while (!in_flight_.empty()) {
+        const auto segment = in_flight_.front();
+        if (!backend_.IsUploadSegmentDone(segment)) break;
+
+        // stays in flight and is mapped again on the next call, dropping it
+        // would shrink the ring for good
+        if (!Map(segment)) break;
+
+        in_flight_.pop_front();
+        auto lock = std::lock_guard {mutex_};
+        free_.emplace_back(segment);
+    }
+}
+
+auto UploadRing::FreeSegments() const -> std::size_t {
+    auto lock = std::lock_guard {mutex_};
+    return free_.size();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/render_backend.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+// A ring of backend upload segments used to stream tiles into the texture
+// array. Free segments stay mapped, so loader threads copy decoded pixels
+// straight into driver memory and the main thread only issues the copy into
+// a layer. A segment is remapped once the backend reports its copy is done.
+class UploadRing {
+public:
+    struct Parameters {
+        std::size_t segment_bytes {0};
+        unsigned int segments {0};
+    };
+
+    struct Staging {
+        unsigned int segment;
+        std::span<std::byte> memory;
+    };
+
+    UploadRing(RenderBackend& backend, const Parameters& params);
+
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    // Thread safe, returns nullopt when every segment is filled or in flight.
+    [[nodiscard]] auto TryAcquire() -> std::optional<Staging>;
+
+    // Thread safe, returns a filled segment that will not be copied.
+    auto Discard(unsigned int segment) -> void;
+
+    // Copies a filled segment into a layer of the texture array.
+    auto CopyTo(unsigned int segment, unsigned int layer) -> void;
+
+    // Remaps segments whose copies have finished, call once per frame.
+    auto Reclaim() -> void;
+
+    [[nodiscard]] auto Segments() const { return static_cast<unsigned int>(mapped_.size()); }
+
+    [[nodiscard]] auto FreeSegments() const -> std::size_t;
+
+    [[nodiscard]] auto InFlight() const { return in_flight_.size(); }
+
+private:
+    RenderBackend& backend_;
+
+    std::vector<std::byte*> mapped_ {};
+
+    // mapped and ready for a loader thread
+    std::vector<unsigned int> free_ {};
+
+    // copies the backend may still be reading, oldest first
+    std::deque<unsigned int> in_flight_ {};
+
+    mutable std::mutex mutex_;
+
+    std::size_t segment_bytes_ {0};
+
+    auto Map(unsigned int segment) -> bool;
+};
\ No newline at end of file
@@ -11,8 +11,8 @@
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
 
+#include "event_bus.h"
 #include "events.h"
-#include "event_dispatcher.h"
 
 static auto glfwMouseButtonMap(int button) -> MouseButton;
 static auto glfwCursorPosCallback(GLFWwindow*, double x, double y) -> void;
@@ -25,6 +25,9 @@ static auto imguiAfterRender() -> void;
 static auto imguiEvent() -> bool;
 static auto imguiCleanup() -> void;
 
+// an idle window still runs a frame this often
+constexpr auto kIdleTimeout = 0.25;
+
 constexpr auto callback_error =
 [](int error, const char* message) {
     std::cout << std::format("Error ({}): {}\n", error, message);
@@ -75,23 +78,44 @@ Window::Window(int width, int height, std::string_view title) {
     glViewport(0, 0, buffer_width, buffer_height);
 }
 
-auto Window::Start(const std::function<void(const double delta)> &program) -> void {
+auto Window::Start(const std::function<bool(const double delta)> &program) -> void {
     timer_.Reset();
 
+    auto presented = true;
     while(!glfwWindowShouldClose(window_)) {
+        if (presented) {
+            glfwPollEvents();
+        } else {
+            glfwWaitEventsTimeout(kIdleTimeout);
+        }
+        // input reaches listeners once per frame, coalesced
+        InputBus::Get().Flush();
+
         imguiBeforeRender();
 
         auto delta = timer_.GetSeconds();
         timer_.Reset();
 
-        program(delta);
+        presented = program(delta);
 
-        imguiAfterRender();
-        glfwSwapBuffers(window_);
-        glfwPollEvents();
+        if (presented) {
+            imguiAfterRender();
+            glfwSwapBuffers(window_);
+        } else {
+            ImGui::EndFrame();
+            skipped_frames_++;
+        }
     }
 }
 
+auto Window::Wake() -> void {
+    glfwPostEmptyEvent();
+}
+
+auto Window::Close() -> void {
+    glfwSetWindowShouldClose(window_, GLFW_TRUE);
+}
+
 Window::~Window() {
     imguiCleanup();
     glfwDestroyWindow(window_);
@@ -99,42 +123,27 @@ Window::~Window() {
 }
 
 static auto glfwCursorPosCallback(GLFWwindow* _, double x, double y) -> void {
-    auto event = std::make_unique<MouseEvent>();
-    event->type = MouseEvent::Type::Moved;
-    event->button = MouseButton::None;
-    event->position = {static_cast<float>(x), static_cast<float>(y)};
-    event->scroll = {0.0f, 0.0f};
-
-    EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+    InputBus::Get().Publish(MouseMoveEvent {
+        .position = {static_cast<float>(x), static_cast<float>(y)}
+    });
 }
 
 static auto glfwMouseButtonCallback(GLFWwindow* window, int button, int action, int) -> void {
     if (imguiEvent()) return;
-    auto event = std::make_unique<MouseEvent>();
-
-    event->type = MouseEvent::Type::ButtonPressed;
-    event->button = glfwMouseButtonMap(button);
-    event->scroll = {0.0f, 0.0f};
-
-    if (action == GLFW_PRESS) {
-        EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
-    }
+    if (action != GLFW_PRESS && action != GLFW_RELEASE) return;
 
-    if (action == GLFW_RELEASE) {
-        event->type = MouseEvent::Type::ButtonReleased;
-        EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
-    }
+    InputBus::Get().Publish(MouseButtonEvent {
+        .button = glfwMouseButtonMap(button),
+        .pressed = action == GLFW_PRESS
+    });
 }
 
 static auto glfwScrollCallback(GLFWwindow* window, double x, double y) -> void {
     if (imguiEvent()) return;
-    auto event = std::make_unique<MouseEvent>();
-
-    event->type = MouseEvent::Type::Scrolled;
-    event->button = MouseButton::None;
-    event->scroll = {static_cast<float>(x), static_cast<float>(y)};
 
-    EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+    InputBus::Get().Publish(MouseScrollEvent {
+        .scroll = {static_cast<float>(x), static_cast<float>(y)}
+    });
 }
 
 static auto glfwMouseButtonMap(int button) -> MouseButton {
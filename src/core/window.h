@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <string_view>
 
@@ -15,11 +16,27 @@ class Window {
 public:
     Window(int width, int height, std::string_view title);
 
-    auto Start(const std::function<void(const double delta)>& program) -> void;
+    // Runs the program once per frame until Close(). The program returns
+    // whether the frame has to be presented. When it doesn't, nothing is
+    // rendered or swapped and the loop sleeps until input arrives, Wake()
+    // is called or the idle timeout passes. Frames after a presented one
+    // start right away, so input and animations stay responsive.
+    auto Start(const std::function<bool(const double delta)>& program) -> void;
+
+    // Thread safe, ends the wait of an idle Start() for the next frame.
+    static auto Wake() -> void;
+
+    // Frames the program chose not to present.
+    [[nodiscard]] auto SkippedFrames() const { return skipped_frames_; }
+
+    // Ends Start() after the current frame.
+    auto Close() -> void;
 
     ~Window();
 
 private:
     GLFWwindow* window_ {nullptr};
     Timer timer_ {};
+
+    std::size_t skipped_frames_ {0};
 };
\ No newline at end of file
@@ -0,0 +1,230 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "http_connection.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <format>
+
+static constexpr auto kTimeoutSeconds = 10;
+static constexpr auto kMaxHeaderBytes = std::size_t {64} << 10;
+// whole-resource responses (loose tiles, servers ignoring ranges)
+static constexpr auto kMaxBodyBytes = std::size_t {64} << 20;
+
+static auto EqualsNoCase(std::string_view a, std::string_view b) {
+    return std::ranges::equal(a, b, [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+static auto Trim(std::string_view value) {
+    while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\r')) value.remove_suffix(1);
+    return value;
+}
+
+auto Url::Parse(std::string_view url) -> std::expected<Url, std::string> {
+    constexpr auto scheme = std::string_view {"http://"};
+    if (!url.starts_with(scheme)) {
+        return std::unexpected(std::format("Unsupported URL '{}', only http:// is supported", url));
+    }
+
+    auto rest = url.substr(scheme.size());
+    auto parsed = Url {};
+    const auto slash = rest.find('/');
+    if (slash != std::string_view::npos) {
+        parsed.path = std::string {rest.substr(slash)};
+        rest = rest.substr(0, slash);
+    }
+
+    const auto colon = rest.find(':');
+    parsed.host = std::string {rest.substr(0, colon)};
+    if (colon != std::string_view::npos) {
+        parsed.port = std::string {rest.substr(colon + 1)};
+    }
+
+    if (parsed.host.empty() || parsed.port.empty()) {
+        return std::unexpected(std::format("Invalid URL '{}'", url));
+    }
+    return parsed;
+}
+
+HttpConnection::HttpConnection(std::string host, std::string port) :
+    host_(std::move(host)),
+    port_(std::move(port)) {}
+
+auto HttpConnection::Get(std::string_view path, std::optional<ByteRange> range)
+    -> std::expected<HttpResponse, std::string>
+{
+    auto request = std::format("GET {} HTTP/1.1\r\nHost: {}\r\n", path, host_);
+    if (range) {
+        request += std::format("Range: bytes={}-{}\r\n", range->offset, range->offset + range->size - 1);
+    }
+    request += "\r\n";
+
+    for (auto attempt = 0;; ++attempt) {
+        // an idle connection may have been dropped by the server since its
+        // last response, that only shows once it is used, so retry once
+        const auto reused = socket_ != net::kInvalidSocket;
+        if (!reused) {
+            if (auto connected = Connect(); !connected) {
+                return std::unexpected(connected.error());
+            }
+        }
+
+        auto response = net::SendAll(socket_, request) ?
+            ReadResponse(range) :
+            std::unexpected(std::string {"connection closed while sending"});
+        if (response) return response;
+
+        Close();
+        if (!reused || attempt > 0) {
+            return std::unexpected(std::format("GET http://{}:{}{} failed: {}", host_, port_, path, response.error()));
+        }
+    }
+}
+
+auto HttpConnection::Connect() -> std::expected<void, std::string> {
+    if (!net::StartSockets()) {
+        return std::unexpected(std::string {"Failed to start sockets"});
+    }
+
+    auto hints = addrinfo {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses) != 0) {
+        return std::unexpected(std::format("Failed to resolve '{}'", host_));
+    }
+
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        socket_ = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket_ == net::kInvalidSocket) continue;
+        if (connect(socket_, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) break;
+        Close();
+    }
+    freeaddrinfo(addresses);
+
+    if (socket_ == net::kInvalidSocket) {
+        return std::unexpected(std::format("Failed to connect to {}:{}", host_, port_));
+    }
+    net::ConfigureSocket(socket_, kTimeoutSeconds);
+    return {};
+}
+
+auto HttpConnection::Close() -> void {
+    if (socket_ != net::kInvalidSocket) {
+        net::CloseSocket(socket_);
+        socket_ = net::kInvalidSocket;
+    }
+    pending_.clear();
+}
+
+auto HttpConnection::Receive() -> bool {
+    auto chunk = std::array<char, 16384> {};
+    const auto received = recv(socket_, chunk.data(), static_cast<int>(chunk.size()), 0);
+    if (received <= 0) return false;
+    pending_.append(chunk.data(), static_cast<std::size_t>(received));
+    return true;
+}
+
+auto HttpConnection::ReadResponse(std::optional<ByteRange> range) -> std::expected<HttpResponse, std::string> {
+    auto header_end = std::string::npos;
+    while ((header_end = pending_.find("\r\n\r\n")) == std::string::npos) {
+        if (pending_.size() > kMaxHeaderBytes) {
+            return std::unexpected(std::string {"response headers too large"});
+        }
+        if (!Receive()) {
+            return std::unexpected(std::string {"connection closed"});
+        }
+    }
+
+    // "HTTP/1.1 206 Partial Content", then one header per line
+    auto response = HttpResponse {};
+    const auto head = std::string_view {pending_}.substr(0, header_end);
+    const auto status = head.substr(std::min(head.find(' ') + 1, head.size()));
+    std::from_chars(status.data(), status.data() + status.size(), response.status);
+
+    auto content_length = std::optional<std::size_t> {};
+    auto keep_alive = true;
+    for (auto line_start = head.find("\r\n"); line_start != std::string_view::npos;) {
+        line_start += 2;
+        const auto line_end = head.find("\r\n", line_start);
+        const auto line = head.substr(line_start, line_end - line_start);
+        line_start = line_end;
+
+        const auto colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        const auto name = line.substr(0, colon);
+        const auto value = Trim(line.substr(colon + 1));
+        if (EqualsNoCase(name, "Content-Length")) {
+            auto length = std::size_t {0};
+            const auto [last, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+            if (error != std::errc {} || last != value.data() + value.size()) {
+                return std::unexpected(std::format("bad Content-Length '{}'", value));
+            }
+            content_length = length;
+        } else if (EqualsNoCase(name, "Connection")) {
+            keep_alive = !EqualsNoCase(value, "close");
+        } else if (EqualsNoCase(name, "Transfer-Encoding") && !EqualsNoCase(value, "identity")) {
+            return std::unexpected(std::format("unsupported transfer encoding '{}'", value));
+        }
+    }
+
+    if (response.status == 0) {
+        return std::unexpected(std::string {"malformed status line"});
+    }
+    if (!content_length && keep_alive) {
+        return std::unexpected(std::string {"response has no Content-Length"});
+    }
+    pending_.erase(0, header_end + 4);
+
+    // the length comes from the server, don't allocate more than was asked for
+    const auto max_body = range && response.status == 206 ?
+        static_cast<std::size_t>(std::min<std::uint64_t>(range->size, kMaxBodyBytes)) :
+        kMaxBodyBytes;
+    if (content_length > max_body) {
+        return std::unexpected(std::format("response body of {} bytes is over the {} byte limit", content_length.value(), max_body));
+    }
+
+    if (content_length) {
+        // the body goes straight from the socket into the response
+        auto& body = response.body;
+        body.resize(content_length.value());
+        auto filled = std::min(pending_.size(), body.size());
+        std::memcpy(body.data(), pending_.data(), filled);
+        pending_.erase(0, filled);
+        while (filled < body.size()) {
+            const auto received = recv(
+                socket_,
+                reinterpret_cast<char*>(body.data() + filled),
+                static_cast<int>(std::min(body.size() - filled, std::size_t {1} << 20)),
+                0
+            );
+            if (received <= 0) {
+                return std::unexpected(std::string {"connection closed mid-body"});
+            }
+            filled += static_cast<std::size_t>(received);
+        }
+    } else {
+        // no length, the body runs until the server closes the connection
+        while (Receive()) {
+            if (pending_.size() > max_body) {
+                return std::unexpected(std::format("response body is over the {} byte limit", max_body));
+            }
+        }
+        response.body.assign(begin(pending_), end(pending_));
+        pending_.clear();
+    }
+
+    if (!keep_alive) Close();
+    return response;
+}
+
+HttpConnection::~HttpConnection() {
+    Close();
+}
\ No newline at end of file
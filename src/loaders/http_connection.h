@@ -0,0 +1,68 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/socket.h"
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// An http:// URL split for a request, https is not supported.
+struct Url {
+    std::string host {};
+    std::string port {"80"};
+    std::string path {"/"};
+
+    [[nodiscard]] static auto Parse(std::string_view url) -> std::expected<Url, std::string>;
+};
+
+struct ByteRange {
+    std::uint64_t offset {0};
+    std::uint64_t size {0};
+};
+
+struct HttpResponse {
+    int status {0};
+    std::vector<unsigned char> body {};
+};
+
+// A blocking HTTP/1.1 connection, kept alive between requests and reopened
+// when the server has closed it. Not thread-safe, pool connections instead.
+// Responses need a Content-Length or Connection: close, chunked transfer
+// encoding is not supported.
+class HttpConnection {
+public:
+    HttpConnection(std::string host, std::string port);
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    // A 206 response holds just the range, servers that ignore ranges
+    // answer 200 with the whole resource.
+    auto Get(std::string_view path, std::optional<ByteRange> range = std::nullopt)
+        -> std::expected<HttpResponse, std::string>;
+
+    ~HttpConnection();
+
+private:
+    std::string host_;
+    std::string port_;
+
+    net::Socket socket_ {net::kInvalidSocket};
+
+    // received past the end of the last response
+    std::string pending_ {};
+
+    auto Connect() -> std::expected<void, std::string>;
+
+    auto Close() -> void;
+
+    auto Receive() -> bool;
+
+    auto ReadResponse(std::optional<ByteRange> range) -> std::expected<HttpResponse, std::string>;
+};
\ No newline at end of file
@@ -0,0 +1,260 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "http_tile_source.h"
+
+#include "loaders/http_connection.h"
+#include "tile_layout.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+
+// the index structs are read with memcpy
+static_assert(std::endian::native == std::endian::little);
+
+// bounds on what a remote header can ask us to fetch and allocate
+static constexpr auto kMaxLods = 32u;
+static constexpr auto kMaxIndexEntries = std::uint64_t {1} << 24;
+
+HttpTileSource::HttpTileSource(const Parameters& params) :
+    grids_(params.grids),
+    max_connections_(std::max(params.connections, 1u)),
+    max_request_bytes_(params.max_request_bytes) {}
+
+auto HttpTileSource::Open(const Parameters& params) -> std::expected<std::shared_ptr<HttpTileSource>, std::string> {
+    auto url = Url::Parse(params.url);
+    if (!url) return std::unexpected(url.error());
+
+    auto source = std::shared_ptr<HttpTileSource>(new HttpTileSource(params));
+    source->host_ = url->host;
+    source->port_ = url->port;
+    source->path_ = url->path;
+
+    if (source->path_.ends_with(".pack")) {
+        if (auto result = source->ReadIndex(); !result) {
+            return std::unexpected(std::format("Invalid tile pack '{}': {}", params.url, result.error()));
+        }
+    } else if (source->path_.ends_with('/')) {
+        source->path_.pop_back();
+    }
+
+    return source;
+}
+
+auto HttpTileSource::ReadIndex() -> std::expected<void, std::string> {
+    auto lock = std::unique_lock {mutex_};
+    auto connection = Acquire(lock);
+    lock.unlock();
+
+    const auto fetch = [&](std::uint64_t offset, std::uint64_t size) -> std::expected<std::vector<unsigned char>, std::string> {
+        auto response = connection->Get(path_, ByteRange {offset, size});
+        if (!response) return std::unexpected(response.error());
+        // a server without range support would send the whole pack for every tile
+        if (response->status != 206 || response->body.size() != size) {
+            return std::unexpected(std::format("expected 206 with {} bytes, got {} with {}", size, response->status, response->body.size()));
+        }
+        return std::move(response->body);
+    };
+
+    auto result = [&]() -> std::expected<void, std::string> {
+        using namespace tile_pack;
+
+        const auto header_bytes = fetch(0, sizeof(Header));
+        if (!header_bytes) return std::unexpected(header_bytes.error());
+        auto header = Header {};
+        std::memcpy(&header, header_bytes->data(), sizeof(Header));
+        if (header.magic != kMagic) {
+            return std::unexpected(std::string {"bad magic"});
+        }
+        if (header.version != kVersion) {
+            return std::unexpected(std::format("unsupported version {}", header.version));
+        }
+        if (header.lods == 0) {
+            return std::unexpected(std::string {"no LODs"});
+        }
+        if (header.lods > kMaxLods) {
+            return std::unexpected(std::format("{} LODs is over the limit of {}", header.lods, kMaxLods));
+        }
+
+        const auto lod_bytes = fetch(sizeof(Header), header.lods * sizeof(LodInfo));
+        if (!lod_bytes) return std::unexpected(lod_bytes.error());
+        grids_.clear();
+        auto entries = std::uint64_t {0};
+        for (auto lod = 0u; lod < header.lods; ++lod) {
+            auto info = LodInfo {};
+            std::memcpy(&info, lod_bytes->data() + lod * sizeof(LodInfo), sizeof(LodInfo));
+            if (info.first_entry != entries) {
+                return std::unexpected(std::format("LOD {} index is out of order", lod));
+            }
+            const auto count = static_cast<std::uint64_t>(info.grid_x) * info.grid_y;
+            if (count > kMaxIndexEntries - entries) {
+                return std::unexpected(std::format("tile index is over the limit of {} entries", kMaxIndexEntries));
+            }
+            grids_.emplace_back(TileGrid {.grid_x = info.grid_x, .grid_y = info.grid_y});
+            first_entry_.emplace_back(entries);
+            entries += count;
+        }
+
+        if (entries == 0) {
+            return std::unexpected(std::string {"no tiles"});
+        }
+
+        const auto index_offset = sizeof(Header) + header.lods * sizeof(LodInfo);
+        const auto entry_bytes = fetch(index_offset, entries * sizeof(Entry));
+        if (!entry_bytes) return std::unexpected(entry_bytes.error());
+        entries_.resize(entries);
+        std::memcpy(entries_.data(), entry_bytes->data(), entry_bytes->size());
+        return {};
+    }();
+
+    Release(std::move(connection));
+    return result;
+}
+
+auto HttpTileSource::Read(unsigned int lod, unsigned int x, unsigned int y) const -> Result {
+    if (lod >= grids_.size() || x >= grids_[lod].grid_x || y >= grids_[lod].grid_y) {
+        return std::unexpected(std::format("Tile {}/{}_{} is outside the pyramid", lod, x, y));
+    }
+    if (entries_.empty()) {
+        return ReadLoose(lod, x, y);
+    }
+
+    const auto& entry = entries_[first_entry_[lod] + static_cast<std::uint64_t>(y) * grids_[lod].grid_x + x];
+    if (entry.size == 0) {
+        return std::unexpected(std::format("Tile {}/{}_{} is missing from the pack", lod, x, y));
+    }
+    return ReadPacked(entry, std::format("{}:{}/{}_{}", path_, lod, x, y));
+}
+
+auto HttpTileSource::ReadPacked(const tile_pack::Entry& entry, std::string name) const -> Result {
+    auto request = std::make_shared<Request>(Request {
+        .range = entry,
+        .name = std::move(name)
+    });
+    auto result = request->result.get_future();
+
+    auto lock = std::unique_lock {mutex_};
+    queue_.emplace_back(request);
+    auto connection = Acquire(lock, request.get());
+    if (connection == nullptr) {
+        // another reader took the request along with its own
+        lock.unlock();
+        return result.get();
+    }
+
+    const auto batch = TakeBatch(request);
+    lock.unlock();
+    // readers whose requests joined the batch stop waiting for a connection
+    available_.notify_all();
+
+    Fetch(*connection, batch);
+    Release(std::move(connection));
+    return result.get();
+}
+
+auto HttpTileSource::ReadLoose(unsigned int lod, unsigned int x, unsigned int y) const -> Result {
+    const auto index = y * grids_[lod].grid_x + x + 1;
+    const auto path = std::format("{}/{}", path_, tile_layout::TilePath(lod, index, "").generic_string());
+
+    auto lock = std::unique_lock {mutex_};
+    auto connection = Acquire(lock);
+    lock.unlock();
+
+    auto response = connection->Get(path);
+    Release(std::move(connection));
+    if (!response) return std::unexpected(response.error());
+    if (response->status != 200) {
+        return std::unexpected(std::format("HTTP {} for '{}'", response->status, path));
+    }
+
+    auto body = std::make_shared<std::vector<unsigned char>>(std::move(response->body));
+    return LoaderBuffer {
+        .bytes = *body,
+        .name = path,
+        .owner = body
+    };
+}
+
+auto HttpTileSource::Acquire(std::unique_lock<std::mutex>& lock, const Request* request) const
+    -> std::unique_ptr<HttpConnection>
+{
+    available_.wait(lock, [&] {
+        return (request && request->taken) || !idle_.empty() || open_ < max_connections_;
+    });
+    if (request && request->taken) return nullptr;
+
+    if (!idle_.empty()) {
+        auto connection = std::move(idle_.back());
+        idle_.pop_back();
+        return connection;
+    }
+    open_++;
+    return std::make_unique<HttpConnection>(host_, port_);
+}
+
+auto HttpTileSource::Release(std::unique_ptr<HttpConnection> connection) const -> void {
+    {
+        auto lock = std::scoped_lock {mutex_};
+        idle_.emplace_back(std::move(connection));
+    }
+    available_.notify_all();
+}
+
+auto HttpTileSource::TakeBatch(const std::shared_ptr<Request>& request) const -> std::vector<std::shared_ptr<Request>> {
+    auto batch = std::vector {request};
+    request->taken = true;
+    auto first = request->range.offset;
+    auto last = request->range.offset + request->range.size;
+
+    // grow the range from both ends while a queued tile borders it
+    for (auto grown = true; grown;) {
+        grown = false;
+        for (const auto& queued : queue_) {
+            if (queued->taken) continue;
+            const auto& range = queued->range;
+            if (last - first + range.size > max_request_bytes_) continue;
+            if (range.offset == last) {
+                last += range.size;
+            } else if (range.offset + range.size == first) {
+                first = range.offset;
+            } else {
+                continue;
+            }
+            queued->taken = true;
+            batch.emplace_back(queued);
+            grown = true;
+        }
+    }
+
+    std::erase_if(queue_, [](const auto& queued) { return queued->taken; });
+    return batch;
+}
+
+auto HttpTileSource::Fetch(HttpConnection& connection, const std::vector<std::shared_ptr<Request>>& batch) const -> void {
+    const auto first = std::ranges::min(batch, {}, [](const auto& r) { return r->range.offset; })->range.offset;
+    auto size = std::uint64_t {0};
+    for (const auto& request : batch) size += request->range.size;
+
+    auto response = connection.Get(path_, ByteRange {first, size});
+    if (response && (response->status != 206 || response->body.size() != size)) {
+        response = std::unexpected(std::format("HTTP {} with {} bytes for a {} byte range", response->status, response->body.size(), size));
+    }
+    if (!response) {
+        for (const auto& request : batch) request->result.set_value(std::unexpected(response.error()));
+        return;
+    }
+
+    // every tile of the batch is a view into the one body
+    auto body = std::make_shared<std::vector<unsigned char>>(std::move(response->body));
+    for (const auto& request : batch) {
+        request->result.set_value(LoaderBuffer {
+            .bytes = {body->data() + (request->range.offset - first), request->range.size},
+            .name = request->name,
+            .owner = body
+        });
+    }
+}
+
+HttpTileSource::~HttpTileSource() = default;
\ No newline at end of file
@@ -0,0 +1,103 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/tile_pack.h"
+#include "loaders/tile_source.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class HttpConnection;
+
+// Tiles fetched from an HTTP server over a pool of keep-alive connections.
+// A URL ending in .pack is a tile pack read with range requests, its index
+// is fetched once on Open(). Reads of tiles stored next to each other in the
+// pack that are waiting at the same time are merged into one request. Any
+// other URL is the root that loose tile files are laid out under.
+class HttpTileSource : public TileSource {
+public:
+    struct Parameters {
+        std::string url {};
+        // the pyramid layout, needed for loose tiles only
+        std::vector<TileGrid> grids {};
+        // connections kept open, also the most requests in flight
+        unsigned int connections {4};
+        // merged pack reads stop growing at this many bytes
+        std::size_t max_request_bytes {4u << 20};
+    };
+
+    HttpTileSource(const HttpTileSource&) = delete;
+    HttpTileSource& operator=(const HttpTileSource&) = delete;
+
+    [[nodiscard]] static auto Open(const Parameters& params) -> std::expected<std::shared_ptr<HttpTileSource>, std::string>;
+
+    [[nodiscard]] auto Read(unsigned int lod, unsigned int x, unsigned int y) const
+        -> std::expected<LoaderBuffer, std::string> override;
+
+    [[nodiscard]] auto Lods() const {
+        return static_cast<unsigned int>(grids_.size());
+    }
+
+    ~HttpTileSource() override;
+
+private:
+    using Result = std::expected<LoaderBuffer, std::string>;
+
+    // a pack read waiting for a connection, any reader holding one may take it
+    struct Request {
+        // where the tile is in the pack
+        tile_pack::Entry range;
+        std::string name;
+        std::promise<Result> result {};
+        bool taken {false};
+    };
+
+    explicit HttpTileSource(const Parameters& params);
+
+    std::string host_ {};
+    std::string port_ {};
+    std::string path_ {};
+
+    std::vector<TileGrid> grids_ {};
+
+    // empty for loose tiles
+    std::vector<tile_pack::Entry> entries_ {};
+    std::vector<std::uint64_t> first_entry_ {};
+
+    unsigned int max_connections_ {0};
+    std::size_t max_request_bytes_ {0};
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable available_;
+    mutable std::vector<std::unique_ptr<HttpConnection>> idle_ {};
+    mutable unsigned int open_ {0};
+    mutable std::vector<std::shared_ptr<Request>> queue_ {};
+
+    auto ReadIndex() -> std::expected<void, std::string>;
+
+    auto ReadPacked(const tile_pack::Entry& entry, std::string name) const -> Result;
+
+    auto ReadLoose(unsigned int lod, unsigned int x, unsigned int y) const -> Result;
+
+    // Waits for a free connection, or until the request was taken by
+    // another reader if there is one. Called with the mutex held.
+    auto Acquire(std::unique_lock<std::mutex>& lock, const Request* request = nullptr) const
+        -> std::unique_ptr<HttpConnection>;
+
+    auto Release(std::unique_ptr<HttpConnection> connection) const -> void;
+
+    // Takes the request and queued ones that extend it into one contiguous
+    // range. Called with the mutex held.
+    auto TakeBatch(const std::shared_ptr<Request>& request) const -> std::vector<std::shared_ptr<Request>>;
+
+    auto Fetch(HttpConnection& connection, const std::vector<std::shared_ptr<Request>>& batch) const -> void;
+};
\ No newline at end of file
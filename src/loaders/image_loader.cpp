@@ -5,29 +5,276 @@
 
 #include "image_loader.h"
 
+#include "loaders/jpeg_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <format>
 #include <iostream>
 
 #include <stb_image.h>
 
-auto ImageLoader::ValidFileExtensions() const -> std::vector<std::string> {
-    return {".png", ".jpg", ".jpeg"};
+// The colour of an interleaved pixel, gray for formats without one. 16-bit
+// samples are little endian, only their high byte is kept.
+static auto ReadRgb(const unsigned char* pixel, PixelFormat format) -> std::array<float, 3> {
+    switch (format) {
+        case PixelFormat::R8:
+        case PixelFormat::RG8: return {pixel[0] * 1.0f, pixel[0] * 1.0f, pixel[0] * 1.0f};
+        case PixelFormat::R16: return {pixel[1] * 1.0f, pixel[1] * 1.0f, pixel[1] * 1.0f};
+        case PixelFormat::RGB8:
+        case PixelFormat::RGBA8: return {pixel[0] * 1.0f, pixel[1] * 1.0f, pixel[2] * 1.0f};
+    }
+    return {};
 }
 
-auto ImageLoader::LoadImpl(const fs::path& path) const -> std::shared_ptr<void> {
+// JFIF's full range BT.601 conversion, chroma averaged over 2x2 pixels.
+static auto ToYCbCr420(const Image& image) -> std::expected<Image, std::string> {
+    const auto planes = Image::Planes(PixelFormat::R8, PixelLayout::YCbCr420, image.width, image.height);
+    auto pixels = ImageData {
+        static_cast<unsigned char*>(std::malloc(Image::Bytes(PixelFormat::R8, PixelLayout::YCbCr420, image.width, image.height))),
+        &std::free
+    };
+    if (pixels == nullptr) {
+        return std::unexpected(std::format("Out of memory converting image '{}'", image.filename));
+    }
+
+    const auto source = image.Data();
+    const auto bytes = PixelBytes(image.format);
+    const auto stride = static_cast<std::size_t>(image.width) * bytes;
+    for (auto y = 0u; y < image.height; ++y) {
+        for (auto x = 0u; x < image.width; ++x) {
+            const auto [r, g, b] = ReadRgb(source + y * stride + x * bytes, image.format);
+            const auto luma = 0.299f * r + 0.587f * g + 0.114f * b;
+            pixels[y * planes[0].stride + x] = static_cast<unsigned char>(luma + 0.5f);
+        }
+    }
+    for (auto y = 0u; y < planes[1].rows; ++y) {
+        for (auto x = 0u; x < planes[1].stride; ++x) {
+            auto r = 0.0f;
+            auto g = 0.0f;
+            auto b = 0.0f;
+            for (auto i = 0u; i < 4; ++i) {
+                const auto px = std::min(x * 2 + i % 2, image.width - 1);
+                const auto py = std::min(y * 2 + i / 2, image.height - 1);
+                const auto rgb = ReadRgb(source + py * stride + px * bytes, image.format);
+                r += rgb[0] / 4.0f;
+                g += rgb[1] / 4.0f;
+                b += rgb[2] / 4.0f;
+            }
+            const auto cb = 128.0f - 0.168736f * r - 0.331264f * g + 0.5f * b;
+            const auto cr = 128.0f + 0.5f * r - 0.418688f * g - 0.081312f * b;
+            pixels[planes[1].offset + y * planes[1].stride + x] = static_cast<unsigned char>(std::clamp(cb + 0.5f, 0.0f, 255.0f));
+            pixels[planes[2].offset + y * planes[2].stride + x] = static_cast<unsigned char>(std::clamp(cr + 0.5f, 0.0f, 255.0f));
+        }
+    }
+
+    return Image {{
+        .filename = image.filename,
+        .width = static_cast<int>(image.width),
+        .height = static_cast<int>(image.height),
+        .depth = static_cast<int>(image.depth),
+        .format = PixelFormat::R8,
+        .layout = PixelLayout::YCbCr420
+    }, std::move(pixels)};
+}
+
+// Decodes with stb, keeping the channels of the file. Single channel 16-bit
+// images stay 16-bit, others with 16 bits per channel are reduced to 8.
+template <typename Is16Bit, typename Load8, typename Load16>
+static auto LoadStb(
+    std::string_view name,
+    Is16Bit&& is_16_bit,
+    Load8&& load_8,
+    Load16&& load_16
+) -> std::expected<Image, std::string> {
     auto width = 0;
     auto height = 0;
     auto depth = 0;
-    auto data = stbi_load(path.string().c_str(), &width, &height, &depth, 4);
+    auto format = PixelFormat::RGBA8;
+    auto data = static_cast<void*>(nullptr);
+    if (is_16_bit()) {
+        data = load_16(&width, &height, &depth);
+        format = PixelFormat::R16;
+        if (data != nullptr && depth != 1) {
+            stbi_image_free(data);
+            data = nullptr;
+        }
+    }
+    if (data == nullptr) {
+        data = load_8(&width, &height, &depth);
+        format = PixelFormatOf(depth);
+    }
 
     if (data == nullptr) {
-        std::cerr << "Failed to load image '" << path.string() << "'\n";
-        return nullptr;
+        return std::unexpected(std::format("Failed to decode image '{}'", name));
     }
 
-    return std::make_shared<Image>(Image {{
-        .filename = path.filename().string(),
+    return Image {{
+        .filename = std::string {name},
         .width = width,
         .height = height,
-        .depth = depth
-    }, ImageData(data, &stbi_image_free)});
+        .depth = depth,
+        .format = format
+    }, ImageData(static_cast<unsigned char*>(data), &stbi_image_free)};
+}
+
+auto ImageLoader::ValidFileExtensions() const -> std::vector<std::string> {
+    return {".png", ".jpg", ".jpeg"};
+}
+
+auto ImageLoader::LoadImpl(const fs::path& path) const -> std::shared_ptr<void> {
+    const auto filename = path.string();
+    auto image = LoadStb(
+        path.filename().string(),
+        [&] { return stbi_is_16_bit(filename.c_str()) != 0; },
+        [&](int* width, int* height, int* depth) {
+            return stbi_load(filename.c_str(), width, height, depth, 0);
+        },
+        [&](int* width, int* height, int* depth) {
+            return stbi_load_16(filename.c_str(), width, height, depth, 0);
+        }
+    );
+
+    if (!image) {
+        std::cerr << "Failed to load image '" << filename << "'\n";
+        return nullptr;
+    }
+
+    return std::make_shared<Image>(std::move(image.value()));
+}
+
+auto ImageLoader::LoadImpl(
+    std::span<const unsigned char> bytes,
+    std::string_view name
+) const -> std::shared_ptr<void> {
+    auto image = Decode(bytes, name);
+    if (!image) {
+        std::cerr << image.error() << '\n';
+        return nullptr;
+    }
+    return std::make_shared<Image>(std::move(image.value()));
+}
+
+auto ImageLoader::Decode(
+    std::span<const unsigned char> bytes,
+    std::string_view name,
+    unsigned int scale
+) const -> std::expected<Image, std::string> {
+    // libjpeg-turbo's SIMD decoder for JPEGs, stb for everything else
+    if (IsJpeg(bytes) && layout_ == PixelLayout::YCbCr420) {
+        // JPEGs in other colour spaces take the interleaved path below
+        auto planes = DecodeJpegPlanes(bytes, name, scale);
+        if (planes && planes->layout == PixelLayout::Interleaved && !keep_gray_) {
+            // grayscale comes out as a single plane
+            return ToYCbCr420(planes.value());
+        }
+        if (planes) return planes;
+    }
+
+    const auto size = static_cast<int>(bytes.size());
+    auto image = IsJpeg(bytes) ? DecodeJpeg(bytes, name, scale) : LoadStb(
+        name,
+        [&] { return stbi_is_16_bit_from_memory(bytes.data(), size) != 0; },
+        [&](int* width, int* height, int* depth) {
+            return stbi_load_from_memory(bytes.data(), size, width, height, depth, 0);
+        },
+        [&](int* width, int* height, int* depth) {
+            return stbi_load_16_from_memory(bytes.data(), size, width, height, depth, 0);
+        }
+    );
+
+    const auto gray = image && PixelChannels(image->format) == 1;
+    if (image && layout_ == PixelLayout::YCbCr420 && (!gray || !keep_gray_)) {
+        return ToYCbCr420(image.value());
+    }
+    return image;
+}
+
+auto ImageLoader::LoadMosaicAsync(
+    std::vector<LoaderSource> sources,
+    unsigned int grid,
+    LoaderCallback<Image> callback,
+    const TaskPriority& priority,
+    std::size_t bytes,
+    std::shared_ptr<CancellationToken> token,
+    std::uint64_t trace_id
+) const -> void {
+    auto self = std::static_pointer_cast<const ImageLoader>(shared_from_this());
+    const auto submitted = Tracer::Get().Now();
+    ThreadPool::Get().Submit([self, sources = std::move(sources), grid, callback, token, trace_id, submitted]() {
+        auto& tracer = Tracer::Get();
+        const auto started = tracer.Now();
+        tracer.Record("queued", trace_id, submitted, started);
+
+        auto pixels = ImageData {nullptr, &std::free};
+        auto params = Image::Parameters {.filename = std::format("mosaic {}x{}", grid, grid)};
+        auto planes = std::vector<Image::Plane> {};
+        auto cells = std::vector<Image::Plane> {};
+        auto decoded = 0u;
+        for (auto i = 0u; i < sources.size(); ++i) {
+            if (token && token->IsCancelled()) return;
+
+            const auto buffer = sources[i]();
+            if (!buffer) continue;
+            if (!IsJpeg(buffer->bytes)) {
+                std::cerr << std::format("Tile '{}' of a mosaic is not a JPEG\n", buffer->name);
+                continue;
+            }
+            const auto image = self->Decode(buffer->bytes, buffer->name, grid);
+            if (!image) {
+                std::cerr << image.error() << '\n';
+                continue;
+            }
+
+            // the first tile decoded sets the cell size, the rest are clipped to it
+            if (!pixels) {
+                params.width = static_cast<int>(image->width * grid);
+                params.height = static_cast<int>(image->height * grid);
+                params.depth = static_cast<int>(image->depth);
+                params.format = image->format;
+                params.layout = image->layout;
+                planes = Image::Planes(params.format, params.layout, params.width, params.height);
+                cells = image->Planes();
+                const auto size = Image::Bytes(params.format, params.layout, params.width, params.height);
+                pixels.reset(static_cast<unsigned char*>(std::calloc(size, 1)));
+                if (!pixels) break;
+                // black has neutral chroma
+                for (auto p = 1u; p < planes.size() && params.layout == PixelLayout::YCbCr420; ++p) {
+                    std::memset(pixels.get() + planes[p].offset, 128, planes[p].stride * planes[p].rows);
+                }
+            }
+
+            if (image->format != params.format || image->layout != params.layout) {
+                std::cerr << std::format("Tile '{}' of a mosaic has a different pixel format\n", buffer->name);
+                continue;
+            }
+
+            const auto from = image->Planes();
+            for (auto p = 0u; p < planes.size() && p < from.size(); ++p) {
+                const auto x = i % grid * cells[p].stride;
+                const auto y = i / grid * cells[p].rows;
+                const auto row_bytes = std::min(from[p].stride, cells[p].stride);
+                for (auto row = 0u; row < std::min(from[p].rows, cells[p].rows); ++row) {
+                    std::memcpy(
+                        pixels.get() + planes[p].offset + (y + row) * planes[p].stride + x,
+                        image->Data() + from[p].offset + row * from[p].stride,
+                        row_bytes
+                    );
+                }
+            }
+            decoded++;
+        }
+        tracer.Record("decode", trace_id, started, tracer.Now());
+        if (token && token->IsCancelled()) return;
+
+        if (decoded == 0) {
+            const auto message = std::format("No tile of a {}x{} mosaic decoded", grid, grid);
+            std::cerr << message << '\n';
+            callback(std::unexpected(message));
+            return;
+        }
+        callback(std::make_shared<Image>(params, std::move(pixels)));
+    }, priority, bytes, token);
 }
\ No newline at end of file
@@ -6,8 +6,13 @@
 #include "core/image.h"
 #include "loaders/loader.h"
 
+#include <cstdint>
+#include <expected>
 #include <filesystem>
 #include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -16,16 +21,63 @@ using ImageCallback = std::function<void(std::shared_ptr<Image>)>;
 
 class ImageLoader : public Loader<Image> {
 public:
+    struct Parameters {
+        // layout of the images loaded from memory. Interleaved images keep
+        // the channels of their file. For YCbCr planes JPEGs decode straight
+        // to them while anything else is converted after decoding.
+        PixelLayout layout {PixelLayout::Interleaved};
+        // with YCbCr planes, single channel images stay one R8 or R16 plane
+        // instead of getting neutral chroma, for grayscale pyramids
+        bool keep_gray {true};
+    };
+
     [[nodiscard]] static auto Create() -> std::shared_ptr<ImageLoader> {
-        return std::shared_ptr<ImageLoader>(new ImageLoader());
+        return Create(Parameters {});
+    }
+
+    [[nodiscard]] static auto Create(const Parameters& params) -> std::shared_ptr<ImageLoader> {
+        return std::shared_ptr<ImageLoader>(new ImageLoader(params));
     }
 
+    // Builds one image from a grid x grid block of finer tiles, row-major in
+    // sources, each decoded at 1/grid of its size with JPEG DCT scaling so
+    // the image comes out at the size of a single tile. grid is 2, 4 or 8.
+    // Cells whose tile is missing or fails to decode stay black, the load
+    // fails only when none of them decodes. Tiles must be JPEGs.
+    auto LoadMosaicAsync(
+        std::vector<LoaderSource> sources,
+        unsigned int grid,
+        LoaderCallback<Image> callback,
+        const TaskPriority& priority = {},
+        std::size_t bytes = 0,
+        std::shared_ptr<CancellationToken> token = nullptr,
+        std::uint64_t trace_id = 0
+    ) const -> void;
+
+    // Decodes on the calling thread to the loader's layout, JPEGs can be
+    // scaled down by 2, 4 or 8.
+    [[nodiscard]] auto Decode(
+        std::span<const unsigned char> bytes,
+        std::string_view name,
+        unsigned int scale = 1
+    ) const -> std::expected<Image, std::string>;
+
     ~ImageLoader() override = default;
 
 private:
-    ImageLoader() = default;
+    PixelLayout layout_ {PixelLayout::Interleaved};
+    bool keep_gray_ {true};
+
+    explicit ImageLoader(const Parameters& params) :
+        layout_(params.layout),
+        keep_gray_(params.keep_gray) {}
 
     [[nodiscard]] auto ValidFileExtensions() const -> std::vector<std::string> override;
 
     [[nodiscard]] auto LoadImpl(const fs::path& path) const -> std::shared_ptr<void> override;
+
+    [[nodiscard]] auto LoadImpl(
+        std::span<const unsigned char> bytes,
+        std::string_view name
+    ) const -> std::shared_ptr<void> override;
 };
\ No newline at end of file
@@ -0,0 +1,260 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "jpeg_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#include <jpeglib.h>
+
+// libjpeg reports fatal errors through error_exit, which must not return.
+// DecodeJpeg sets the jump target first and keeps no objects with
+// destructors alive across the libjpeg calls.
+struct ErrorManager {
+    jpeg_error_mgr manager;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+static auto ErrorExit(j_common_ptr info) -> void {
+    auto errors = reinterpret_cast<ErrorManager*>(info->err);
+    (*info->err->format_message)(info, errors->message);
+    std::longjmp(errors->jump, 1);
+}
+
+// warnings about recoverable corruption, the decoder carries on regardless
+static auto OutputMessage(j_common_ptr) -> void {}
+
+// Samples along each axis a block of the component decodes to. Scaled
+// decodes give subsampled chroma larger blocks than luma where they can,
+// to upsample it in the IDCT, so this differs between components.
+static auto ScaledBlockSize(const jpeg_component_info& component) -> unsigned int {
+#if JPEG_LIB_VERSION >= 70
+    return static_cast<unsigned int>(component.DCT_h_scaled_size);
+#else
+    return static_cast<unsigned int>(component.DCT_scaled_size);
+#endif
+}
+
+auto IsJpeg(std::span<const unsigned char> bytes) -> bool {
+    return bytes.size() > 3 && bytes[0] == 0xFF && bytes[1] == 0xD8 && bytes[2] == 0xFF;
+}
+
+auto DecodeJpeg(
+    std::span<const unsigned char> bytes,
+    std::string_view name,
+    unsigned int scale
+) -> std::expected<Image, std::string> {
+    auto info = jpeg_decompress_struct {};
+    auto errors = ErrorManager {};
+    // written after setjmp, volatile so the error path sees the buffer
+    unsigned char* volatile pixels = nullptr;
+
+    info.err = jpeg_std_error(&errors.manager);
+    errors.manager.error_exit = ErrorExit;
+    errors.manager.output_message = OutputMessage;
+
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_decompress(&info);
+        std::free(pixels);
+        return std::unexpected(std::format("Failed to decode image '{}': {}", name, errors.message));
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, bytes.data(), static_cast<unsigned long>(bytes.size()));
+    jpeg_read_header(&info, TRUE);
+
+    const auto gray = info.jpeg_color_space == JCS_GRAYSCALE;
+    info.out_color_space = gray ? JCS_GRAYSCALE : JCS_RGB;
+    info.scale_num = 1;
+    info.scale_denom = scale;
+    jpeg_start_decompress(&info);
+
+    const auto stride = static_cast<std::size_t>(info.output_width) * info.output_components;
+    pixels = static_cast<unsigned char*>(std::malloc(stride * info.output_height));
+    if (pixels == nullptr) {
+        jpeg_destroy_decompress(&info);
+        return std::unexpected(std::format("Out of memory decoding image '{}'", name));
+    }
+
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW row = pixels + info.output_scanline * stride;
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_decompress(&info);
+
+    const auto width = static_cast<int>(info.output_width);
+    const auto height = static_cast<int>(info.output_height);
+    const auto depth = info.num_components;
+    jpeg_destroy_decompress(&info);
+
+    return Image {{
+        .filename = std::string {name},
+        .width = width,
+        .height = height,
+        .depth = depth,
+        .format = gray ? PixelFormat::R8 : PixelFormat::RGB8
+    }, ImageData(pixels, &std::free)};
+}
+
+// Box filters a plane by 1 or 2 along each axis into one of half size or
+// the same size, samples past the edge repeat the last row and column.
+static auto ReduceChroma(
+    const unsigned char* from,
+    std::size_t from_stride,
+    unsigned int from_width,
+    unsigned int from_height,
+    unsigned char* to,
+    const Image::Plane& plane,
+    unsigned int step_x,
+    unsigned int step_y
+) {
+    const auto width = static_cast<unsigned int>(plane.stride);
+    for (auto y = 0u; y < plane.rows; ++y) {
+        const auto row0 = from + std::min(y * step_y, from_height - 1) * from_stride;
+        const auto row1 = from + std::min(y * step_y + step_y - 1, from_height - 1) * from_stride;
+        auto out = to + plane.offset + y * plane.stride;
+        if (step_x == 1 && step_y == 1) {
+            std::memcpy(out, row0, width);
+            continue;
+        }
+        for (auto x = 0u; x < width; ++x) {
+            const auto x0 = std::min(x * step_x, from_width - 1);
+            const auto x1 = std::min(x * step_x + step_x - 1, from_width - 1);
+            const auto sum = row0[x0] + row0[x1] + row1[x0] + row1[x1];
+            out[x] = static_cast<unsigned char>((sum + 2) >> 2);
+        }
+    }
+}
+
+auto DecodeJpegPlanes(
+    std::span<const unsigned char> bytes,
+    std::string_view name,
+    unsigned int scale
+) -> std::expected<Image, std::string> {
+    auto info = jpeg_decompress_struct {};
+    auto errors = ErrorManager {};
+    // every component at its stored resolution, padded to whole blocks
+    unsigned char* volatile samples = nullptr;
+
+    info.err = jpeg_std_error(&errors.manager);
+    errors.manager.error_exit = ErrorExit;
+    errors.manager.output_message = OutputMessage;
+
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_decompress(&info);
+        std::free(samples);
+        return std::unexpected(std::format("Failed to decode image '{}': {}", name, errors.message));
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, bytes.data(), static_cast<unsigned long>(bytes.size()));
+    jpeg_read_header(&info, TRUE);
+
+    // luma at up to twice the chroma resolution, chroma at most halved
+    const auto gray = info.jpeg_color_space == JCS_GRAYSCALE && info.num_components == 1;
+    auto supported = gray;
+    if (info.jpeg_color_space == JCS_YCbCr && info.num_components == 3) {
+        supported = info.comp_info[0].h_samp_factor <= 2 && info.comp_info[0].v_samp_factor <= 2;
+        for (auto c = 1; c < 3; ++c) {
+            supported = supported && info.comp_info[c].h_samp_factor == 1 && info.comp_info[c].v_samp_factor == 1;
+        }
+    }
+    if (!supported) {
+        jpeg_destroy_decompress(&info);
+        return std::unexpected(std::format("Image '{}' has no YCbCr 4:2:0 compatible layout", name));
+    }
+
+    info.raw_data_out = TRUE;
+    info.out_color_space = info.jpeg_color_space;
+    info.scale_num = 1;
+    info.scale_denom = scale;
+    jpeg_start_decompress(&info);
+
+    // rows are read an iMCU row at a time, max_v_samp_factor luma blocks tall
+    const auto components = info.num_components;
+    auto blocks = std::array<unsigned int, 3> {};
+    auto strides = std::array<std::size_t, 3> {};
+    auto offsets = std::array<std::size_t, 3> {};
+    auto total = std::size_t {0};
+    for (auto c = 0; c < components; ++c) {
+        const auto& component = info.comp_info[c];
+        const auto columns = (component.width_in_blocks + component.h_samp_factor - 1) /
+            component.h_samp_factor * component.h_samp_factor;
+        blocks[c] = ScaledBlockSize(component);
+        strides[c] = static_cast<std::size_t>(columns) * blocks[c];
+        offsets[c] = total;
+        total += strides[c] * info.total_iMCU_rows * component.v_samp_factor * blocks[c];
+    }
+    samples = static_cast<unsigned char*>(std::malloc(total));
+    if (samples == nullptr) {
+        jpeg_destroy_decompress(&info);
+        return std::unexpected(std::format("Out of memory decoding image '{}'", name));
+    }
+
+    // at most 2 blocks of luma and 1 of each chroma per iMCU row
+    auto rows = std::array<JSAMPROW, 3 * 2 * DCTSIZE> {};
+    auto planes = std::array<JSAMPARRAY, 3> {};
+    const auto imcu_rows = static_cast<unsigned int>(info.max_v_samp_factor) * blocks[0];
+    while (info.output_scanline < info.output_height) {
+        const auto imcu = info.output_scanline / imcu_rows;
+        auto next = rows.data();
+        for (auto c = 0; c < components; ++c) {
+            const auto count = static_cast<unsigned int>(info.comp_info[c].v_samp_factor) * blocks[c];
+            planes[c] = next;
+            for (auto row = 0u; row < count; ++row) {
+                *next++ = samples + offsets[c] + (imcu * count + row) * strides[c];
+            }
+        }
+        jpeg_read_raw_data(&info, planes.data(), imcu_rows);
+    }
+
+    // the component info goes with the image, read it before finishing
+    const auto width = info.output_width;
+    const auto height = info.output_height;
+    auto dims = std::array<std::pair<unsigned int, unsigned int>, 3> {};
+    for (auto c = 0; c < components; ++c) {
+        dims[c] = {info.comp_info[c].downsampled_width, info.comp_info[c].downsampled_height};
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+
+    const auto out_layout = gray ? PixelLayout::Interleaved : PixelLayout::YCbCr420;
+    const auto layout = Image::Planes(PixelFormat::R8, out_layout, width, height);
+    auto pixels = ImageData {
+        static_cast<unsigned char*>(std::malloc(Image::Bytes(PixelFormat::R8, out_layout, width, height))),
+        &std::free
+    };
+    if (pixels == nullptr) {
+        std::free(samples);
+        return std::unexpected(std::format("Out of memory decoding image '{}'", name));
+    }
+
+    for (auto row = 0u; row < height; ++row) {
+        std::memcpy(pixels.get() + row * layout[0].stride, samples + row * strides[0], width);
+    }
+    for (auto c = 1u; c < layout.size(); ++c) {
+        // chroma comes out at half or full size, whatever was stored
+        const auto [plane_width, plane_height] = dims[c];
+        const auto step_x = plane_width > layout[c].stride ? 2u : 1u;
+        const auto step_y = plane_height > layout[c].rows ? 2u : 1u;
+        ReduceChroma(samples + offsets[c], strides[c], plane_width, plane_height, pixels.get(), layout[c], step_x, step_y);
+    }
+    std::free(samples);
+
+    return Image {{
+        .filename = std::string {name},
+        .width = static_cast<int>(width),
+        .height = static_cast<int>(height),
+        .depth = components,
+        .format = PixelFormat::R8,
+        .layout = out_layout
+    }, std::move(pixels)};
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/image.h"
+
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+// True for the bytes of a JPEG file, from its start of image marker.
+[[nodiscard]] auto IsJpeg(std::span<const unsigned char> bytes) -> bool;
+
+// Decodes a JPEG to RGB8, or R8 when it is grayscale, with libjpeg-turbo.
+// A scale of 2, 4 or 8 decodes
+// the image at that fraction of its size in the DCT domain, which skips
+// most of the inverse DCT and colour conversion work.
+[[nodiscard]] auto DecodeJpeg(
+    std::span<const unsigned char> bytes,
+    std::string_view name,
+    unsigned int scale = 1
+) -> std::expected<Image, std::string>;
+
+// Decodes a YCbCr JPEG to PixelLayout::YCbCr420 planes as they come out of
+// the inverse DCT, with no colour conversion and no chroma upsampling.
+// Chroma stored at more than half resolution is averaged down. A grayscale
+// JPEG has no chroma and comes out as a single R8 plane. Fails for other
+// colour spaces and subsamplings, scale works as in DecodeJpeg().
+[[nodiscard]] auto DecodeJpegPlanes(
+    std::span<const unsigned char> bytes,
+    std::string_view name,
+    unsigned int scale = 1
+) -> std::expected<Image, std::string>;
\ No newline at end of file
@@ -4,15 +4,22 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <expected>
 #include <filesystem>
 #include <format>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
-#include <thread>
+#include <span>
+#include <string>
 #include <vector>
 
+#include "core/cancellation_token.h"
+#include "core/thread_pool.h"
+#include "core/tracer.h"
+
 namespace fs = std::filesystem;
 
 template <typename T>
@@ -21,34 +28,111 @@ using LoaderResult = std::expected<std::shared_ptr<T>, std::string>;
 template <typename T>
 using LoaderCallback = std::function<void(LoaderResult<T>)>;
 
+// Encoded bytes that are already in memory, owner keeps them alive
+// (e.g. a mapped tile pack) until the load is done.
+struct LoaderBuffer {
+    std::span<const unsigned char> bytes {};
+    std::string name {};
+    std::shared_ptr<const void> owner {nullptr};
+};
+
+// Produces the encoded bytes of a resource, called on a loader thread.
+using LoaderSource = std::function<std::expected<LoaderBuffer, std::string>()>;
+
+// Reads a whole file, the buffer owns the bytes.
+inline auto ReadFile(const fs::path& path) -> std::expected<LoaderBuffer, std::string> {
+    auto file = std::ifstream {path, std::ios::binary | std::ios::ate};
+    if (!file) {
+        return std::unexpected(std::format("Failed to open '{}'", path.string()));
+    }
+
+    auto data = std::make_shared<std::vector<unsigned char>>(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data->data()), static_cast<std::streamsize>(data->size()));
+    if (!file) {
+        return std::unexpected(std::format("Failed to read '{}'", path.string()));
+    }
+
+    return LoaderBuffer {
+        .bytes = *data,
+        .name = path.filename().string(),
+        .owner = data
+    };
+}
+
 template <typename Resource>
 class Loader : public std::enable_shared_from_this<Loader<Resource>> {
 public:
     auto Load(const fs::path& path, LoaderCallback<Resource> callback) const {
         if (!ValidateFile(path, callback)) return;
-        auto resource = std::static_pointer_cast<Resource>(LoadImpl(path));
-        if (resource) {
-            callback(resource);
-        } else {
-            const auto message = std::format("Failed to load resource '{}'", path.string());
-            std::cerr << message << '\n';
-            callback(std::unexpected(message));
-        }
+        Complete(LoadImpl(path), path.string(), callback);
+    }
+
+    auto Load(const LoaderBuffer& buffer, LoaderCallback<Resource> callback) const {
+        Complete(LoadImpl(buffer.bytes, buffer.name), buffer.name, callback);
     }
 
-    auto LoadAsync(const fs::path& path, LoaderCallback<Resource> callback) const {
+    // The callback is not invoked if the token is cancelled before the load
+    // finishes, the token is checked before and after the resource is decoded.
+    auto LoadAsync(
+        const fs::path& path,
+        LoaderCallback<Resource> callback,
+        const TaskPriority& priority = {},
+        std::size_t bytes = 0,
+        std::shared_ptr<CancellationToken> token = nullptr,
+        std::uint64_t trace_id = 0
+    ) const {
         if (!ValidateFile(path, callback)) return;
+        LoadAsync([path]() { return ReadFile(path); }, callback, priority, bytes, token, trace_id);
+    }
+
+    auto LoadAsync(
+        const LoaderBuffer& buffer,
+        LoaderCallback<Resource> callback,
+        const TaskPriority& priority = {},
+        std::size_t bytes = 0,
+        std::shared_ptr<CancellationToken> token = nullptr,
+        std::uint64_t trace_id = 0
+    ) const {
+        LoadAsync([buffer]() -> std::expected<LoaderBuffer, std::string> {
+            return buffer;
+        }, callback, priority, bytes, token, trace_id);
+    }
+
+    // Reads the encoded bytes with source on the loader thread, then decodes
+    // them. Queue wait, read and decode are traced under trace_id.
+    auto LoadAsync(
+        LoaderSource source,
+        LoaderCallback<Resource> callback,
+        const TaskPriority& priority = {},
+        std::size_t bytes = 0,
+        std::shared_ptr<CancellationToken> token = nullptr,
+        std::uint64_t trace_id = 0
+    ) const {
         auto self = this->shared_from_this();
-        std::thread([self, path, callback]() {
-            auto resource = std::static_pointer_cast<Resource>(self->LoadImpl(path));
-            if (resource) {
-                callback(resource);
-            } else {
-                const auto message = std::format("Failed to load resource '{}'", path.string());
-                std::cerr << message << '\n';
-                callback(std::unexpected(message));
+        const auto submitted = Tracer::Get().Now();
+        ThreadPool::Get().Submit([self, source = std::move(source), callback, token, trace_id, submitted]() {
+            auto& tracer = Tracer::Get();
+            const auto started = tracer.Now();
+            tracer.Record("queued", trace_id, submitted, started);
+            if (token && token->IsCancelled()) return;
+
+            const auto buffer = source();
+            const auto read = tracer.Now();
+            tracer.Record("read", trace_id, started, read);
+            // a slow read may outlive the request, don't decode for nothing
+            if (token && token->IsCancelled()) return;
+            if (!buffer) {
+                std::cerr << buffer.error() << '\n';
+                callback(std::unexpected(buffer.error()));
+                return;
             }
-        }).detach();
+
+            auto resource = self->LoadImpl(buffer->bytes, buffer->name);
+            tracer.Record("decode", trace_id, read, tracer.Now());
+            if (token && token->IsCancelled()) return;
+            self->Complete(resource, buffer->name, callback);
+        }, priority, bytes, token);
     }
 
     virtual ~Loader() = default;
@@ -58,7 +142,27 @@ protected:
 
     [[nodiscard]] virtual auto LoadImpl(const fs::path& path) const -> std::shared_ptr<void> = 0;
 
+    [[nodiscard]] virtual auto LoadImpl(
+        std::span<const unsigned char> bytes,
+        std::string_view name
+    ) const -> std::shared_ptr<void> = 0;
+
 private:
+    auto Complete(
+        std::shared_ptr<void> result,
+        std::string_view name,
+        const LoaderCallback<Resource>& callback
+    ) const {
+        auto resource = std::static_pointer_cast<Resource>(result);
+        if (resource) {
+            callback(resource);
+        } else {
+            const auto message = std::format("Failed to load resource '{}'", name);
+            std::cerr << message << '\n';
+            callback(std::unexpected(message));
+        }
+    }
+
     auto ValidateFile(const fs::path& path, LoaderCallback<Resource> callback) const {
         if (!ValidateFileType(path)) {
             const auto& str = path.extension().string();
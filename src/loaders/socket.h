@@ -0,0 +1,86 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <string_view>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+// The few socket calls that differ between Winsock and POSIX. Only include
+// this from translation units, it pulls in the platform headers.
+namespace net {
+#ifdef _WIN32
+    using Socket = SOCKET;
+    constexpr auto kInvalidSocket = INVALID_SOCKET;
+    constexpr auto kSendFlags = 0;
+
+    inline auto CloseSocket(Socket socket) { closesocket(socket); }
+
+    // wakes a thread blocked on the socket in accept() or recv()
+    inline auto ShutdownSocket(Socket socket) { shutdown(socket, SD_BOTH); }
+
+    // Winsock has to be started once per process before any other call
+    inline auto StartSockets() {
+        static const auto started = [] {
+            auto data = WSADATA {};
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return started;
+    }
+#else
+    using Socket = int;
+    constexpr auto kInvalidSocket = -1;
+    // a peer closing the connection is an error to handle, not a signal
+    #ifdef MSG_NOSIGNAL
+        constexpr auto kSendFlags = MSG_NOSIGNAL;
+    #else
+        constexpr auto kSendFlags = 0;
+    #endif
+
+    inline auto CloseSocket(Socket socket) { close(socket); }
+
+    // wakes a thread blocked on the socket in accept() or recv()
+    inline auto ShutdownSocket(Socket socket) { shutdown(socket, SHUT_RDWR); }
+
+    inline auto StartSockets() { return true; }
+#endif
+
+    // Low latency for small requests, a receive timeout so a dead peer
+    // doesn't block a loader thread forever.
+    inline auto ConfigureSocket(Socket socket, int timeout_seconds) {
+        auto enable = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+    #ifdef SO_NOSIGPIPE
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+    #endif
+    #ifdef _WIN32
+        const auto timeout = static_cast<DWORD>(timeout_seconds * 1000);
+    #else
+        const auto timeout = timeval {.tv_sec = timeout_seconds, .tv_usec = 0};
+    #endif
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    }
+
+    // False if the connection broke before everything was sent.
+    inline auto SendAll(Socket socket, std::string_view data) {
+        while (!data.empty()) {
+            const auto sent = send(socket, data.data(), static_cast<int>(data.size()), kSendFlags);
+            if (sent <= 0) return false;
+            data.remove_prefix(static_cast<std::size_t>(sent));
+        }
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "tile_pack.h"
+
+#include <bit>
+#include <cstring>
+#include <format>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// the on-disk structs are read and written with memcpy
+static_assert(std::endian::native == std::endian::little);
+
+using namespace tile_pack;
+
+template <typename T>
+static auto ReadAt(const std::byte* data, std::size_t offset) -> T {
+    auto value = T {};
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+auto TilePack::Open(const fs::path& path) -> std::expected<std::shared_ptr<TilePack>, std::string> {
+    auto pack = std::shared_ptr<TilePack>(new TilePack());
+    pack->name_ = path.filename().string();
+
+    if (auto result = pack->Map(path); !result) {
+        return std::unexpected(result.error());
+    }
+
+    if (auto result = pack->Validate(); !result) {
+        return std::unexpected(std::format("Invalid tile pack '{}': {}", path.string(), result.error()));
+    }
+
+    return pack;
+}
+
+auto TilePack::Map(const fs::path& path) -> std::expected<void, std::string> {
+#ifdef _WIN32
+    file_ = CreateFileW(
+        path.wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_RANDOM_ACCESS,
+        nullptr
+    );
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        return std::unexpected(std::format("Failed to open tile pack '{}'", path.string()));
+    }
+
+    auto size = LARGE_INTEGER {};
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+        data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(std::format("Failed to open tile pack '{}'", path.string()));
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        size_ = static_cast<std::size_t>(info.st_size);
+        auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            // tile access follows the viewport, not the file order
+            madvise(data, size_, MADV_RANDOM);
+            data_ = static_cast<const std::byte*>(data);
+        }
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+
+    if (data_ == nullptr) {
+        return std::unexpected(std::format("Failed to map tile pack '{}'", path.string()));
+    }
+
+    return {};
+}
+
+auto TilePack::Validate() -> std::expected<void, std::string> {
+    if (size_ < sizeof(Header)) {
+        return std::unexpected("file is too small");
+    }
+
+    const auto header = ReadAt<Header>(data_, 0);
+    if (header.magic != kMagic) {
+        return std::unexpected("bad magic");
+    }
+    if (header.version != kVersion) {
+        return std::unexpected(std::format("unsupported version {}", header.version));
+    }
+
+    const auto index_offset = sizeof(Header) + header.lods * sizeof(LodInfo);
+    if (index_offset > size_) {
+        return std::unexpected("truncated LOD table");
+    }
+
+    // checked against what fits in the file as it is summed, so crafted
+    // grids can't wrap the arithmetic past the size check
+    const auto max_entries = static_cast<std::uint64_t>((size_ - index_offset) / sizeof(Entry));
+    auto entries = std::uint64_t {0};
+    for (auto lod = 0u; lod < header.lods; ++lod) {
+        const auto info = ReadAt<LodInfo>(data_, sizeof(Header) + lod * sizeof(LodInfo));
+        if (info.first_entry != entries) {
+            return std::unexpected(std::format("LOD {} index is out of order", lod));
+        }
+        const auto count = static_cast<std::uint64_t>(info.grid_x) * info.grid_y;
+        if (count > max_entries - entries) {
+            return std::unexpected("truncated tile index");
+        }
+        grids_.emplace_back(info.grid_x, info.grid_y);
+        first_entry_.emplace_back(index_offset + info.first_entry * sizeof(Entry));
+        entries += count;
+    }
+
+    tile_size_ = header.tile_size;
+
+    return {};
+}
+
+auto TilePack::Tile(unsigned int lod, unsigned int x, unsigned int y) const -> std::optional<LoaderBuffer> {
+    if (lod >= grids_.size()) return std::nullopt;
+
+    const auto& grid = grids_[lod];
+    if (x >= grid.grid_x || y >= grid.grid_y) return std::nullopt;
+
+    const auto index = static_cast<std::uint64_t>(y) * grid.grid_x + x;
+    const auto entry = ReadAt<Entry>(data_, first_entry_[lod] + index * sizeof(Entry));
+    if (entry.size == 0 || entry.offset > size_ || entry.size > size_ - entry.offset) {
+        return std::nullopt;
+    }
+
+    return LoaderBuffer {
+        .bytes = {reinterpret_cast<const unsigned char*>(data_ + entry.offset), entry.size},
+        .name = std::format("{}:{}/{}_{}", name_, lod, x, y),
+        .owner = shared_from_this()
+    };
+}
+
+TilePack::~TilePack() {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+#else
+    if (data_) munmap(const_cast<std::byte*>(data_), size_);
+#endif
+    data_ = nullptr;
+}
+
+TilePackWriter::TilePackWriter(
+    const fs::path& path,
+    unsigned int tile_size,
+    const std::vector<TileGrid>& grids
+) : file_(path, std::ios::binary | std::ios::trunc), grids_(grids) {
+    auto entries = std::uint64_t {0};
+    for (const auto& grid : grids_) {
+        first_entry_.emplace_back(entries);
+        entries += static_cast<std::uint64_t>(grid.grid_x) * grid.grid_y;
+    }
+    entries_.resize(entries, Entry {0, 0});
+
+    const auto header = Header {
+        .magic = kMagic,
+        .version = kVersion,
+        .tile_size = tile_size,
+        .lods = static_cast<std::uint32_t>(grids_.size())
+    };
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (auto lod = 0u; lod < grids_.size(); ++lod) {
+        const auto info = LodInfo {
+            .grid_x = grids_[lod].grid_x,
+            .grid_y = grids_[lod].grid_y,
+            .first_entry = first_entry_[lod]
+        };
+        file_.write(reinterpret_cast<const char*>(&info), sizeof(info));
+    }
+
+    // placeholder index, rewritten by Finish()
+    file_.write(
+        reinterpret_cast<const char*>(entries_.data()),
+        static_cast<std::streamsize>(entries_.size() * sizeof(Entry))
+    );
+
+    offset_ = sizeof(Header) + grids_.size() * sizeof(LodInfo) + entries_.size() * sizeof(Entry);
+}
+
+auto TilePackWriter::AddTile(
+    unsigned int lod,
+    unsigned int x,
+    unsigned int y,
+    std::span<const unsigned char> bytes
+) -> bool {
+    if (lod >= grids_.size() || x >= grids_[lod].grid_x || y >= grids_[lod].grid_y) {
+        return false;
+    }
+
+    const auto index = first_entry_[lod] + static_cast<std::uint64_t>(y) * grids_[lod].grid_x + x;
+    entries_[index] = Entry {.offset = offset_, .size = bytes.size()};
+
+    file_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    offset_ += bytes.size();
+
+    return file_.good();
+}
+
+auto TilePackWriter::Finish() -> bool {
+    file_.seekp(static_cast<std::streamoff>(sizeof(Header) + grids_.size() * sizeof(LodInfo)));
+    file_.write(
+        reinterpret_cast<const char*>(entries_.data()),
+        static_cast<std::streamsize>(entries_.size() * sizeof(Entry))
+    );
+    file_.close();
+    return !file_.fail();
+}
\ No newline at end of file
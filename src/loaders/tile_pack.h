@@ -0,0 +1,118 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/loader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Pack layout, all integers little-endian:
+//   Header
+//   LodInfo[header.lods]
+//   Entry[sum of grid_x * grid_y over all LODs], row-major per LOD
+//   tile payloads (encoded images), concatenated
+namespace tile_pack {
+    constexpr auto kMagic = std::uint32_t {0x4B504C47}; // 'GLPK'
+    constexpr auto kVersion = std::uint32_t {1};
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t tile_size;
+        std::uint32_t lods;
+    };
+
+    struct LodInfo {
+        std::uint32_t grid_x;
+        std::uint32_t grid_y;
+        std::uint64_t first_entry;
+    };
+
+    struct Entry {
+        std::uint64_t offset; // from the start of the file
+        std::uint64_t size; // 0 for a missing tile
+    };
+
+    static_assert(sizeof(Header) == 16);
+    static_assert(sizeof(LodInfo) == 16);
+    static_assert(sizeof(Entry) == 16);
+}
+
+struct TileGrid {
+    unsigned int grid_x {0};
+    unsigned int grid_y {0};
+};
+
+class TilePack : public std::enable_shared_from_this<TilePack> {
+public:
+    TilePack(const TilePack&) = delete;
+    TilePack& operator=(const TilePack&) = delete;
+
+    [[nodiscard]] static auto Open(const fs::path& path) -> std::expected<std::shared_ptr<TilePack>, std::string>;
+
+    // The returned buffer keeps the mapping alive, missing tiles return nullopt.
+    [[nodiscard]] auto Tile(unsigned int lod, unsigned int x, unsigned int y) const -> std::optional<LoaderBuffer>;
+
+    [[nodiscard]] auto TileSize() const { return tile_size_; }
+
+    [[nodiscard]] auto Lods() const { return static_cast<unsigned int>(grids_.size()); }
+
+    [[nodiscard]] auto Grid(unsigned int lod) const { return grids_.at(lod); }
+
+    ~TilePack();
+
+private:
+    TilePack() = default;
+
+    const std::byte* data_ {nullptr};
+    std::size_t size_ {0};
+
+#ifdef _WIN32
+    void* file_ {nullptr};
+    void* mapping_ {nullptr};
+#endif
+
+    std::string name_ {};
+    std::vector<TileGrid> grids_ {};
+    std::vector<std::uint64_t> first_entry_ {};
+
+    unsigned int tile_size_ {0};
+
+    auto Map(const fs::path& path) -> std::expected<void, std::string>;
+
+    auto Validate() -> std::expected<void, std::string>;
+};
+
+// Writes a pack in one pass. The index is reserved up front and filled in
+// by Finish(), so tiles can be added in any order without buffering them.
+class TilePackWriter {
+public:
+    TilePackWriter(const fs::path& path, unsigned int tile_size, const std::vector<TileGrid>& grids);
+
+    [[nodiscard]] auto IsOpen() const { return file_.is_open(); }
+
+    auto AddTile(unsigned int lod, unsigned int x, unsigned int y, std::span<const unsigned char> bytes) -> bool;
+
+    auto Finish() -> bool;
+
+private:
+    std::ofstream file_;
+
+    std::vector<TileGrid> grids_;
+    std::vector<std::uint64_t> first_entry_;
+    std::vector<tile_pack::Entry> entries_;
+
+    std::uint64_t offset_ {0};
+};
\ No newline at end of file
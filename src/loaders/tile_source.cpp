@@ -0,0 +1,64 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "tile_source.h"
+
+#include "tile_layout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <random>
+#include <thread>
+
+FileTileSource::FileTileSource(std::vector<TileGrid> grids, const fs::path& root) :
+    grids_(std::move(grids)),
+    root_(root) {}
+
+auto FileTileSource::Read(unsigned int lod, unsigned int x, unsigned int y) const
+    -> std::expected<LoaderBuffer, std::string>
+{
+    if (lod >= grids_.size() || x >= grids_[lod].grid_x || y >= grids_[lod].grid_y) {
+        return std::unexpected(std::format("Tile {}/{}_{} is outside the pyramid", lod, x, y));
+    }
+    const auto index = y * grids_[lod].grid_x + x + 1;
+    return ReadFile(tile_layout::TilePath(lod, index, root_));
+}
+
+auto PackTileSource::Read(unsigned int lod, unsigned int x, unsigned int y) const
+    -> std::expected<LoaderBuffer, std::string>
+{
+    if (auto tile = pack_->Tile(lod, x, y)) {
+        return tile.value();
+    }
+    return std::unexpected(std::format("Tile {}/{}_{} is missing from the pack", lod, x, y));
+}
+
+auto SimulatedTileSource::Read(unsigned int lod, unsigned int x, unsigned int y) const
+    -> std::expected<LoaderBuffer, std::string>
+{
+    using namespace std::chrono;
+
+    const auto requested = Clock::now();
+    auto buffer = source_->Read(lod, x, y);
+    if (!buffer) return buffer;
+
+    static thread_local std::mt19937 rng(std::random_device{}());
+    auto latency = params_.latency_ms;
+    if (params_.jitter_ms > 0.0f) {
+        latency += std::uniform_real_distribution(0.0f, params_.jitter_ms)(rng);
+    }
+
+    const auto first_byte = requested + duration_cast<Clock::duration>(duration<float, std::milli>(latency));
+    auto done = first_byte;
+    if (params_.bandwidth_mb > 0.0f) {
+        const auto seconds = static_cast<double>(buffer->bytes.size()) / (params_.bandwidth_mb * 1e6);
+        const auto transfer = duration_cast<Clock::duration>(duration<double>(seconds));
+        auto lock = std::scoped_lock {mutex_};
+        link_free_ = std::max(link_free_, first_byte) + transfer;
+        done = link_free_;
+    }
+
+    std::this_thread::sleep_until(done);
+    return buffer;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/loader.h"
+#include "loaders/tile_pack.h"
+
+#include "core/timer.h"
+
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Where the encoded bytes of pyramid tiles come from. Read() is called on a
+// loader thread and may block for as long as the storage takes.
+class TileSource {
+public:
+    [[nodiscard]] virtual auto Read(unsigned int lod, unsigned int x, unsigned int y) const
+        -> std::expected<LoaderBuffer, std::string> = 0;
+
+    virtual ~TileSource() = default;
+};
+
+// Loose files named by tile_layout, the grids turn x and y into file indices.
+class FileTileSource : public TileSource {
+public:
+    FileTileSource(std::vector<TileGrid> grids, const fs::path& root);
+
+    [[nodiscard]] auto Read(unsigned int lod, unsigned int x, unsigned int y) const
+        -> std::expected<LoaderBuffer, std::string> override;
+
+private:
+    std::vector<TileGrid> grids_;
+    fs::path root_;
+};
+
+// Tiles of a mapped pack, a read hands out a view of the mapping.
+class PackTileSource : public TileSource {
+public:
+    explicit PackTileSource(std::shared_ptr<TilePack> pack) : pack_(std::move(pack)) {}
+
+    [[nodiscard]] auto Read(unsigned int lod, unsigned int x, unsigned int y) const
+        -> std::expected<LoaderBuffer, std::string> override;
+
+private:
+    std::shared_ptr<TilePack> pack_;
+};
+
+// Delays another source the way remote storage would. Every request waits
+// out the latency plus a random jitter, then its bytes go through a single
+// link whose bandwidth all requests share.
+class SimulatedTileSource : public TileSource {
+public:
+    struct Parameters {
+        float latency_ms {0.0f};
+        // up to this much is added to the latency of each request
+        float jitter_ms {0.0f};
+        // megabytes per second, 0 for unlimited
+        float bandwidth_mb {0.0f};
+    };
+
+    SimulatedTileSource(std::shared_ptr<TileSource> source, const Parameters& params) :
+        source_(std::move(source)),
+        params_(params) {}
+
+    [[nodiscard]] auto Read(unsigned int lod, unsigned int x, unsigned int y) const
+        -> std::expected<LoaderBuffer, std::string> override;
+
+private:
+    std::shared_ptr<TileSource> source_;
+
+    Parameters params_;
+
+    // when the link finishes the transfers queued on it so far
+    mutable std::mutex mutex_;
+    mutable Clock::time_point link_free_ {};
+};
\ No newline at end of file
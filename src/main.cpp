@@ -1,22 +1,28 @@
 // Copyright © 2024 - Present, Shlomi Nissan.
 // All rights reserved.
 
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
 #include <print>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "core/gl_render_backend.h"
 #include "core/orthographic_camera.h"
-#include "core/shaders.h"
+#include "core/tracer.h"
 #include "core/window.h"
-#include "geometries/plane_geometry.h"
 #include "resources/zoom_pan_camera.h"
 
-#include "shaders/headers/scene_frag.h"
-#include "shaders/headers/scene_vert.h"
-#include "shaders/headers/line_vert.h"
-#include "shaders/headers/line_frag.h"
-
+#include "camera_path.h"
 #include "chunk.h"
 #include "chunk_manager.h"
+#include "chunk_manager_panel.h"
+#include "perf_overlay.h"
+#include "replay_report.h"
+#include "tile_renderer.h"
 
 #include <imgui.h>
 
@@ -25,85 +31,195 @@ struct Bounds {
     glm::vec2 max {0.0f};
 };
 
-auto main() -> int {
+struct Options {
+    // saves the camera of every frame on exit
+    fs::path record {};
+    // drives the camera from a recording, then prints a report and exits
+    fs::path replay {};
+    // traces tile loads from the start and saves them on exit
+    fs::path trace {};
+    // fetches tiles from an HTTP server instead of assets/
+    std::string url {};
+    // redraws every frame instead of only when something changed
+    bool continuous {false};
+    // delays tile reads like remote storage, set by any of the network options
+    std::optional<SimulatedTileSource::Parameters> simulate {};
+    // LODs above this are decoded from finer tiles, -1 for only missing ones
+    int derive_above {-1};
+};
+
+static auto ParseOptions(int argc, char** argv) -> std::optional<Options> {
+    auto options = Options {};
+    auto simulate = [&]() -> SimulatedTileSource::Parameters& {
+        if (!options.simulate) options.simulate.emplace();
+        return options.simulate.value();
+    };
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view {argv[i]};
+        const auto has_value = i + 1 < argc;
+        if (arg == "--record" && has_value) {
+            options.record = argv[++i];
+        } else if (arg == "--replay" && has_value) {
+            options.replay = argv[++i];
+        } else if (arg == "--trace" && has_value) {
+            options.trace = argv[++i];
+        } else if (arg == "--continuous") {
+            options.continuous = true;
+        } else if (arg == "--url" && has_value) {
+            options.url = argv[++i];
+        } else if (arg == "--latency" && has_value) {
+            simulate().latency_ms = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--jitter" && has_value) {
+            simulate().jitter_ms = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--bandwidth" && has_value) {
+            simulate().bandwidth_mb = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--derive-above" && has_value) {
+            options.derive_above = std::max(std::atoi(argv[++i]), 0);
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+auto main(int argc, char** argv) -> int {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        std::print(stderr,
+            "usage: tiling [options]\n"
+            "  --record <file>      save the camera path on exit\n"
+            "  --replay <file>      play a recorded camera path, print a report and exit\n"
+            "  --trace <file>       save a Chrome trace of tile loads on exit\n"
+            "  --continuous         redraw every frame, not just when something changed\n"
+            "  --url <url>          tile pack URL ending in .pack, or the URL of loose tiles\n"
+            "  --latency <ms>       delay every tile read like remote storage\n"
+            "  --jitter <ms>        random extra delay of up to this much per read\n"
+            "  --bandwidth <MB/s>   bandwidth shared by all tile reads\n"
+            "  --derive-above <lod> decode coarser LODs from finer tiles even if stored\n"
+        );
+        return EXIT_FAILURE;
+    }
+
+    if (!options->trace.empty()) {
+        Tracer::Get().SetEnabled(true);
+    }
+
+    auto recording = CameraPath {};
+    auto replay = std::optional<CameraPath> {};
+    if (!options->replay.empty()) {
+        auto path = CameraPath::Load(options->replay);
+        if (!path) {
+            std::print(stderr, "{}\n", path.error());
+            return EXIT_FAILURE;
+        }
+        if (path->Frames() == 0) {
+            std::print(stderr, "The camera path is empty\n");
+            return EXIT_FAILURE;
+        }
+        replay = std::move(path.value());
+    }
+
     constexpr auto win_width = 1024;
     constexpr auto win_height = 1024;
     constexpr auto aspect = static_cast<float>(win_width) / win_height;
     constexpr auto camera_width = 2048.0f; // 2048 x 2048 virtual units
     constexpr auto camera_height = camera_width / aspect;
     constexpr auto lods = 3;
+    constexpr auto pack = "assets/pyramid.pack";
 
+    auto window = Window {win_width, win_height, "Tiling"};
+    auto backend = GlRenderBackend {};
     auto chunk_manager = ChunkManager {{
         .image_dims = {2048, 2048},
         .window_dims = {win_width, win_height},
-        .lods = lods
-    }};
-
-    auto window = Window {win_width, win_height, "Tiling"};
+        .lods = lods,
+        .pack = fs::exists(pack) ? pack : "",
+        .url = options->url,
+        .simulate = options->simulate,
+        .derive_above = options->derive_above,
+        .on_load = Window::Wake
+    }, backend};
     auto camera = OrthographicCamera {0.0f, camera_width, camera_height, 0.0f, -1.0f, 1.0f};
     auto controls = ZoomPanCamera {&camera};
-    auto geometry = PlaneGeometry {{
-        .width = 512.0f,
-        .height = 512.0f,
-        .width_segments = 1,
-        .height_segments = 1
-    }};
-
-    auto shader_tile = Shaders {{
-        {ShaderType::kVertexShader, _SHADER_scene_vert},
-        {ShaderType::kFragmentShader, _SHADER_scene_frag}
-    }};
-
-    auto shader_line = Shaders {{
-        {ShaderType::kVertexShader, _SHADER_line_vert},
-        {ShaderType::kFragmentShader, _SHADER_line_frag}
-    }};
-
-    window.Start([&]([[maybe_unused]] const double _){
+    auto renderer = TileRenderer {backend};
+    auto report = ReplayReport {};
+    auto panel = ChunkManagerPanel {};
+    auto overlay = PerfOverlay {};
+    auto frame = std::size_t {0};
+    // time since the last presented frame, the recording skips the others
+    auto record_delta = 0.0;
+    auto ui_was_active = false;
+
+    window.Start([&](const double delta){
+        const auto previous_transform = camera.transform;
+        if (replay) {
+            // frame-locked, every recorded frame is shown once however long it takes
+            camera.transform = (*replay)[frame].transform;
+            controls.TrackMotion(frame == 0 ? 0.0 : (*replay)[frame].delta);
+        } else {
+            controls.Update(delta);
+        }
+        chunk_manager.Update(camera, controls.Velocity());
+        panel.Draw(chunk_manager);
+        overlay.Draw(chunk_manager, window.SkippedFrames());
+
+        const auto tiles = chunk_manager.GetVisibleTiles();
+
+        // redraw when the camera moved, tiles came or went, or the UI is in
+        // use, one more frame after it was in use to show it settled
+        const auto& io = ImGui::GetIO();
+        const auto ui_active = io.WantCaptureMouse || io.WantCaptureKeyboard || ImGui::IsAnyItemActive();
+        const auto dirty =
+            options->continuous || replay || frame < 2 ||
+            camera.transform != previous_transform ||
+            chunk_manager.Changed() ||
+            ui_active || ui_was_active;
+        ui_was_active = ui_active;
+        frame++;
+        record_delta += delta;
+        if (!dirty) return false;
+
+        if (!options->record.empty()) {
+            recording.Record(camera.transform, record_delta);
+        }
+        record_delta = 0.0;
+
+        overlay.BeginFrame(backend);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        controls.Update();
-        chunk_manager.Update(camera);
-        chunk_manager.Debug();
-
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDisable(GL_BLEND);
-
-        shader_tile.Use();
-        shader_tile.SetUniform("u_Projection", camera.Projection());
-
-        // render textured tiles
+        renderer.Draw(tiles, camera);
+        if (chunk_manager.show_wireframes) {
+            renderer.DrawWireframes(tiles, camera);
+        }
 
-        auto chunks = chunk_manager.GetVisibleChunks();
-        for (auto& chunk : chunks) {
-            if (chunk->State() != ChunkState::Loaded) {
-                continue;
+        overlay.EndFrame(backend, delta * 1000.0);
+        if (replay) {
+            report.AddFrame(delta * 1000.0, camera.transform, chunk_manager.IsSharp());
+            if (frame == replay->Frames()) {
+                report.Print(chunk_manager.Residency());
+                window.Close();
             }
-            chunk->Texture().Bind();
-            shader_tile.SetUniform("u_ModelView", camera.View() * chunk->ModelMatrix());
-            geometry.Draw(shader_tile);
         }
+        return true;
+    });
 
-        // render wireframes
+    std::print("Skipped {} of {} frames\n", window.SkippedFrames(), frame);
 
-        if (chunk_manager.show_wireframes) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            shader_line.Use();
-            shader_line.SetUniform("u_Projection", camera.Projection());
-
-            for (const auto& chunk : chunks) {
-                if (chunk->Lod() != chunk_manager.curr_lod ||
-                    chunk->State() != ChunkState::Loaded) {
-                    continue;
-                }
-                shader_line.SetUniform("u_ModelView", camera.View() * chunk->ModelMatrix());
-                geometry.Draw(shader_line);
-            }
+    if (!options->record.empty()) {
+        if (auto result = recording.Save(options->record); !result) {
+            std::print(stderr, "{}\n", result.error());
+            return EXIT_FAILURE;
         }
-    });
+        std::print("Recorded {} frames to '{}'\n", recording.Frames(), options->record.string());
+    }
+
+    if (!options->trace.empty()) {
+        if (auto result = Tracer::Get().Save(options->trace); !result) {
+            std::print(stderr, "{}\n", result.error());
+            return EXIT_FAILURE;
+        }
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "perf_overlay.h"
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <imgui.h>
+
+auto PerfOverlay::BeginFrame(RenderBackend& backend) -> void {
+    timing_ = open_;
+    if (timing_) backend.BeginGpuTimer();
+}
+
+auto PerfOverlay::EndFrame(RenderBackend& backend, double frame_ms) -> void {
+    if (timing_) backend.EndGpuTimer();
+    frame_ms_[head_] = static_cast<float>(frame_ms);
+    gpu_ms_[head_] = timing_ ? backend.GpuMilliseconds() : 0.0f;
+    head_ = (head_ + 1) % kHistory;
+}
+
+auto PerfOverlay::Draw(const ChunkManager& chunk_manager, std::size_t skipped_frames) -> void {
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    const auto was_open = open_;
+    open_ = ImGui::Begin("Performance");
+    if (!open_) {
+        ImGui::End();
+        return;
+    }
+
+    const auto residency = chunk_manager.Residency();
+    if (!was_open || rate_timer_.GetSeconds() >= 1.0) {
+        UpdateRates(residency, !was_open);
+    }
+
+    const auto latest = (head_ + kHistory - 1) % kHistory;
+    const auto mean_ms = std::accumulate(begin(frame_ms_), end(frame_ms_), 0.0f) / kHistory;
+    ImGui::Text("Frame: %.2f ms (mean %.2f ms)", frame_ms_[latest], mean_ms);
+    ImGui::PlotLines("##frame", frame_ms_.data(), kHistory, static_cast<int>(head_), "frame ms", 0.0f, 33.3f, ImVec2 {0.0f, 48.0f});
+    ImGui::Text("GPU: %.2f ms", gpu_ms_[latest]);
+    ImGui::PlotLines("##gpu", gpu_ms_.data(), kHistory, static_cast<int>(head_), "gpu ms", 0.0f, 16.7f, ImVec2 {0.0f, 48.0f});
+    ImGui::Text("Skipped frames: %zu", skipped_frames);
+    ImGui::Separator();
+
+    const auto uploads = chunk_manager.Uploads();
+    ImGui::Text("Decode queue: %zu", ThreadPool::Get().QueueSize());
+    ImGui::Text("Upload backlog: %zu", uploads.pending);
+
+    const auto fraction = residency.budget ? static_cast<float>(residency.resident_bytes) / residency.budget : 0.0f;
+    ImGui::ProgressBar(fraction, ImVec2 {-1.0f, 0.0f});
+    ImGui::Text("Resident: %zu / %zu MB", residency.resident_bytes >> 20, residency.budget >> 20);
+    ImGui::Text("Hit rate: %.0f%%", hit_rate_ * 100.0f);
+    ImGui::Text("Tiles loaded: %.1f /s", tiles_per_second_);
+
+    const auto samples = chunk_manager.LoadLatencies();
+    if (!samples.empty()) {
+        latencies_.assign(begin(samples), end(samples));
+        const auto percentile = [&](float p) {
+            const auto nth = begin(latencies_) + static_cast<std::ptrdiff_t>(p * (latencies_.size() - 1));
+            std::ranges::nth_element(latencies_, nth);
+            return *nth;
+        };
+        const auto p50 = percentile(0.5f);
+        const auto p99 = percentile(0.99f);
+        ImGui::Text("Load latency: p50 %.0f ms, p99 %.0f ms", p50, p99);
+    } else {
+        ImGui::Text("Load latency: no samples");
+    }
+
+    ImGui::End();
+}
+
+auto PerfOverlay::UpdateRates(const ResidencyCache::Stats& residency, bool restart) -> void {
+    // the first sample after opening only sets the baseline, the counters
+    // kept running while the window was collapsed
+    if (!restart) {
+        const auto seconds = static_cast<float>(rate_timer_.GetSeconds());
+        tiles_per_second_ = static_cast<float>(residency.loaded - last_loaded_) / seconds;
+        const auto hits = residency.hits - last_hits_;
+        const auto lookups = hits + residency.misses - last_misses_;
+        if (lookups > 0) hit_rate_ = static_cast<float>(hits) / lookups;
+    }
+
+    last_loaded_ = residency.loaded;
+    last_hits_ = residency.hits;
+    last_misses_ = residency.misses;
+    rate_timer_.Reset();
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "chunk_manager.h"
+
+#include "core/render_backend.h"
+#include "core/timer.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Frame and tile pipeline metrics in an ImGui window. The window starts
+// collapsed, and while it is collapsed a frame costs a couple of stores and
+// an empty window, no GPU queries, locks or sorting.
+class PerfOverlay {
+public:
+    // Brackets the frame, GPU time is only measured while the window is open.
+    auto BeginFrame(RenderBackend& backend) -> void;
+
+    auto EndFrame(RenderBackend& backend, double frame_ms) -> void;
+
+    // Skipped frames are those the window did not present, nothing changed.
+    auto Draw(const ChunkManager& chunk_manager, std::size_t skipped_frames) -> void;
+
+private:
+    static constexpr auto kHistory = std::size_t {120};
+
+    // frame history, oldest at head_
+    std::array<float, kHistory> frame_ms_ {};
+    std::array<float, kHistory> gpu_ms_ {};
+    std::size_t head_ {0};
+
+    // rates over the last second, sampled while the window is open
+    Timer rate_timer_ {};
+    std::size_t last_loaded_ {0};
+    std::size_t last_hits_ {0};
+    std::size_t last_misses_ {0};
+    float tiles_per_second_ {0.0f};
+    float hit_rate_ {0.0f};
+
+    std::vector<float> latencies_ {};
+
+    bool open_ {false};
+    bool timing_ {false};
+
+    auto UpdateRates(const ResidencyCache::Stats& residency, bool restart) -> void;
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "replay_report.h"
+
+#include <algorithm>
+#include <numeric>
+#include <print>
+
+static auto Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const auto rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+auto ReplayReport::AddFrame(double frame_ms, const glm::mat4& transform, bool sharp) -> void {
+    // the first frame starts at rest
+    if (frame_ms_.empty()) prev_transform_ = transform;
+    frame_ms_.emplace_back(frame_ms);
+
+    const auto moving = transform != prev_transform_;
+    prev_transform_ = transform;
+
+    if (moving) {
+        if (waiting_) abandoned_++;
+        waiting_ = false;
+        measured_ = false;
+        return;
+    }
+
+    if (measured_) return;
+
+    if (!waiting_) {
+        waiting_ = true;
+        settled_.Reset();
+    }
+
+    if (sharp) {
+        time_to_sharp_.emplace_back(settled_.GetSeconds());
+        waiting_ = false;
+        measured_ = true;
+    }
+}
+
+auto ReplayReport::Print(const ResidencyCache::Stats& residency) const -> void {
+    auto frames = frame_ms_;
+    std::ranges::sort(frames);
+    auto sharp = time_to_sharp_;
+    std::ranges::sort(sharp);
+
+    const auto mean_sharp = sharp.empty() ? 0.0 :
+        std::accumulate(begin(sharp), end(sharp), 0.0) / static_cast<double>(sharp.size());
+
+    std::print(
+        "frames          {}\n"
+        "frame time      p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms\n"
+        "viewports       {} sharp, {} left before sharp{}\n"
+        "time to sharp   mean {:.0f} ms, p90 {:.0f} ms, max {:.0f} ms\n"
+        "tiles loaded    {}\n"
+        "tiles wasted    {} (never drawn)\n",
+        frames.size(),
+        Percentile(frames, 0.5), Percentile(frames, 0.9), Percentile(frames, 0.99), Percentile(frames, 1.0),
+        sharp.size(), abandoned_, waiting_ ? ", last one still loading" : "",
+        mean_sharp * 1000.0, Percentile(sharp, 0.9) * 1000.0, Percentile(sharp, 1.0) * 1000.0,
+        residency.loaded,
+        residency.wasted
+    );
+}
\ No newline at end of file
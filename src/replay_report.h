@@ -0,0 +1,38 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "residency_cache.h"
+
+#include "core/timer.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+// Collects the numbers compared between builds on a replayed camera path.
+// A viewport starts when the camera comes to rest, it is sharp once every
+// visible tile of the current LOD is on the GPU.
+class ReplayReport {
+public:
+    // Call once per frame, after the frame has been drawn.
+    auto AddFrame(double frame_ms, const glm::mat4& transform, bool sharp) -> void;
+
+    auto Print(const ResidencyCache::Stats& residency) const -> void;
+
+private:
+    std::vector<double> frame_ms_ {};
+
+    // seconds from the camera coming to rest until the view is sharp
+    std::vector<double> time_to_sharp_ {};
+
+    // viewports the camera left before they were sharp
+    std::size_t abandoned_ {0};
+
+    glm::mat4 prev_transform_ {0.0f};
+    bool waiting_ {false};
+    bool measured_ {false};
+    Timer settled_ {};
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "residency_cache.h"
+
+#include "core/tracer.h"
+
+#include <iterator>
+
+auto ResidencyCache::Touch(Chunk* chunk, bool pinned) -> void {
+    Use(chunk, pinned, true);
+}
+
+auto ResidencyCache::KeepAlive(Chunk* chunk, bool pinned) -> void {
+    Use(chunk, pinned, false);
+}
+
+auto ResidencyCache::Track(Chunk* chunk, bool pinned) -> void {
+    if (entries_.contains(chunk)) return;
+    Add(chunk, pinned, false);
+}
+
+auto ResidencyCache::Remove(const Chunk* chunk) -> void {
+    if (auto entry = entries_.find(chunk); entry != end(entries_)) {
+        Erase(entry->second);
+    }
+}
+
+auto ResidencyCache::Evict(const std::function<bool(const Chunk*)>& wanted) -> void {
+    if (wanted) {
+        EvictPass([&](const Entry& entry) { return !entry.drawn && wanted(entry.chunk); });
+    }
+    EvictPass([](const Entry&) { return false; });
+}
+
+auto ResidencyCache::GetStats() const -> Stats {
+    return {
+        .budget = budget_,
+        .resident_bytes = usage_,
+        .undrawn_bytes = undrawn_bytes_,
+        .resident_chunks = lru_.size(),
+        .evictions = evictions_,
+        .evicted_bytes = evicted_bytes_,
+        .loaded = loaded_,
+        .wasted = evicted_undrawn_ + undrawn_,
+        .hits = hits_,
+        .misses = misses_
+    };
+}
+
+auto ResidencyCache::Use(Chunk* chunk, bool pinned, bool drawn) -> void {
+    auto entry = entries_.find(chunk);
+    auto iter = entry != end(entries_) ? entry->second : Add(chunk, pinned, false);
+    iter->last_used = frame_;
+    if (drawn && !iter->drawn) {
+        Tracer::Get().Record("first draw", chunk->Key());
+        iter->drawn = true;
+        undrawn_--;
+        undrawn_bytes_ -= iter->bytes;
+    }
+    lru_.splice(begin(lru_), lru_, iter);
+}
+
+auto ResidencyCache::Add(Chunk* chunk, bool pinned, bool drawn) -> std::list<Entry>::iterator {
+    // new entries count as used, or a tile that just arrived would be the
+    // first evicted once the cache is full
+    const auto bytes = chunk->Bytes();
+    lru_.emplace_front(Entry {chunk, bytes, pinned, drawn, frame_});
+    auto entry = begin(lru_);
+    entries_.emplace(chunk, entry);
+    usage_ += bytes;
+    if (!drawn) {
+        undrawn_++;
+        undrawn_bytes_ += bytes;
+    }
+    loaded_++;
+    return entry;
+}
+
+auto ResidencyCache::Erase(std::list<Entry>::iterator entry) -> std::list<Entry>::iterator {
+    usage_ -= entry->bytes;
+    if (!entry->drawn) {
+        undrawn_--;
+        undrawn_bytes_ -= entry->bytes;
+    }
+    entries_.erase(entry->chunk);
+    return lru_.erase(entry);
+}
+
+auto ResidencyCache::EvictPass(const std::function<bool(const Entry&)>& spare) -> void {
+    for (auto iter = rbegin(lru_); iter != rend(lru_) && usage_ > budget_;) {
+        auto chunk = iter->chunk;
+        if (chunk->State() == ChunkState::Loaded) {
+            if (iter->pinned || iter->last_used == frame_ || spare(*iter)) {
+                ++iter;
+                continue;
+            }
+
+            release_(chunk);
+            evictions_++;
+            evicted_bytes_ += iter->bytes;
+            if (!iter->drawn) evicted_undrawn_++;
+        }
+
+        // erase through the base iterator, then continue from the element before it
+        iter = std::make_reverse_iterator(Erase(std::next(iter).base()));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "chunk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+// Keeps the memory held by loaded chunks under a budget by evicting the
+// chunks that were visible least recently. Pinned chunks count towards the
+// usage but are never evicted.
+class ResidencyCache {
+public:
+    struct Stats {
+        std::size_t budget {0};
+        std::size_t resident_bytes {0};
+        std::size_t undrawn_bytes {0};
+        std::size_t resident_chunks {0};
+        std::size_t evictions {0};
+        std::size_t evicted_bytes {0};
+        // chunks that became resident, and those evicted or still resident
+        // without ever being drawn
+        std::size_t loaded {0};
+        std::size_t wasted {0};
+        // tiles that were or weren't loaded when they were first needed
+        std::size_t hits {0};
+        std::size_t misses {0};
+    };
+
+    // Called for every evicted chunk, it must leave the chunk unloaded.
+    using ReleaseCallback = std::function<void(Chunk*)>;
+
+    ResidencyCache(std::size_t budget, ReleaseCallback release) :
+        release_(std::move(release)),
+        budget_(budget) {}
+
+    auto BeginFrame() -> void { frame_++; }
+
+    // Marks a loaded chunk as drawn this frame, tracking it if it is new.
+    auto Touch(Chunk* chunk, bool pinned = false) -> void;
+
+    // Makes a loaded chunk recently used without counting it as drawn, for
+    // tiles that are needed but still wait for an upload.
+    auto KeepAlive(Chunk* chunk, bool pinned = false) -> void;
+
+    // Starts tracking a loaded chunk as used this frame but not yet drawn.
+    auto Track(Chunk* chunk, bool pinned = false) -> void;
+
+    // Stops tracking a chunk that was unloaded without being evicted.
+    auto Remove(const Chunk* chunk) -> void;
+
+    // Evicts unpinned chunks not used this frame until usage is in budget.
+    // Undrawn chunks the caller still wants, e.g. prefetched tiles ahead of
+    // the camera, only go once nothing else is left.
+    auto Evict(const std::function<bool(const Chunk*)>& wanted = {}) -> void;
+
+    // Counts a tile needed for display, a hit if it was already loaded.
+    auto CountLookup(bool hit) -> void { hit ? hits_++ : misses_++; }
+
+    auto SetBudget(std::size_t budget) -> void { budget_ = budget; }
+
+    [[nodiscard]] auto Contains(const Chunk* chunk) const -> bool {
+        return entries_.contains(chunk);
+    }
+
+    [[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+    struct Entry {
+        Chunk* chunk;
+        std::size_t bytes;
+        bool pinned;
+        bool drawn;
+        std::uint64_t last_used;
+    };
+
+    // most recently used at the front
+    std::list<Entry> lru_ {};
+    std::unordered_map<const Chunk*, std::list<Entry>::iterator> entries_ {};
+
+    ReleaseCallback release_;
+
+    std::uint64_t frame_ {0};
+
+    std::size_t budget_ {0};
+    // running totals over the tracked entries
+    std::size_t usage_ {0};
+    std::size_t undrawn_ {0};
+    std::size_t undrawn_bytes_ {0};
+    std::size_t evictions_ {0};
+    std::size_t evicted_bytes_ {0};
+    std::size_t loaded_ {0};
+    std::size_t evicted_undrawn_ {0};
+    std::size_t hits_ {0};
+    std::size_t misses_ {0};
+
+    auto Use(Chunk* chunk, bool pinned, bool drawn) -> void;
+
+    auto Add(Chunk* chunk, bool pinned, bool drawn) -> std::list<Entry>::iterator;
+
+    auto Erase(std::list<Entry>::iterator entry) -> std::list<Entry>::iterator;
+
+    // One pass from the least recently used end, skipping the spared chunks.
+    auto EvictPass(const std::function<bool(const Entry&)>& spare) -> void;
+};
\ No newline at end of file
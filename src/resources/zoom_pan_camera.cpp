@@ -3,34 +3,37 @@
 
 #include "zoom_pan_camera.h"
 
+#include <cmath>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 ZoomPanCamera::ZoomPanCamera(OrthographicCamera* camera) : camera_(camera)  {
-    using enum MouseEvent::Type;
-    using enum MouseButton;
-
-    mouse_event_listener_ = std::make_shared<EventListener>([this](Event* event) {
-        if (auto e = event->As<MouseEvent>()) {
-            if ((e->type == ButtonPressed || e->type == ButtonReleased) && e->button == Left) {
-                is_panning_ = e->type == ButtonPressed;
-                if (!is_panning_) {
-                    is_first_pan_ = true;
-                }
-            }
-            if (e->type == Moved) {
-                mouse_position_ = e->position;
-                if (is_panning_) {
-                    pan_ = true;
-                }
+    // record the starting view, there is no motion yet
+    TrackMotion(0.0);
+
+    auto& input = InputBus::Get();
+    subscriptions_ = {
+        input.Subscribe<MouseButtonEvent>([this](const MouseButtonEvent& e) {
+            if (e.button != MouseButton::Left) return;
+            is_panning_ = e.pressed;
+            if (!is_panning_) {
+                is_first_pan_ = true;
             }
-            if (e->type == Scrolled) {
-                curr_scroll_ = e->scroll.y;
-                if (curr_scroll_ != 0.0f) zoom_ = true;
+        }),
+        input.Subscribe<MouseMoveEvent>([this](const MouseMoveEvent& e) {
+            mouse_position_ = e.position;
+            if (is_panning_) {
+                pan_ = true;
             }
-        }
-    });
-
-    EventDispatcher::Get().AddEventListener("mouse_event", mouse_event_listener_);
+        }),
+        // a frame's scrolls arrive summed into one
+        input.Subscribe<MouseScrollEvent>([this](const MouseScrollEvent& e) {
+            curr_scroll_ = e.scroll.y;
+            if (curr_scroll_ != 0.0f) zoom_ = true;
+        })
+    };
 }
 
 auto ZoomPanCamera::Pan() -> void {
@@ -66,13 +69,35 @@ auto ZoomPanCamera::Zoom() -> void {
     camera_->transform = glm::translate(camera_->transform, glm::vec3 {-x_offset, -y_offset, 0.0f});
 }
 
-auto ZoomPanCamera::Update() -> void {
+auto ZoomPanCamera::Update(double delta) -> void {
     if (zoom_) Zoom();
     if (pan_) Pan();
+    TrackMotion(delta);
+}
+
+auto ZoomPanCamera::TrackMotion(double delta) -> void {
+    const auto& transform = camera_->transform;
+    const auto center = glm::vec2 {transform * glm::vec4 {camera_->Width() / 2.0f, camera_->Height() / 2.0f, 0.0f, 1.0f}};
+    const auto scale = glm::length(glm::vec3 {transform[0]});
+
+    if (delta > 0.0) {
+        const auto dt = static_cast<float>(delta);
+        const auto pan = (center - prev_center_) / dt;
+        const auto zoom = std::log2(scale / prev_scale_) / dt;
+
+        // input arrives in bursts, average over roughly 100ms
+        const auto weight = 1.0f - std::exp(-dt / 0.1f);
+        velocity_.pan = glm::mix(velocity_.pan, pan, weight);
+        velocity_.zoom = glm::mix(velocity_.zoom, zoom, weight);
+    }
+
+    prev_center_ = center;
+    prev_scale_ = scale;
 }
 
 ZoomPanCamera::~ZoomPanCamera() {
-    EventDispatcher::Get().RemoveEventListener("mouse_event", mouse_event_listener_);
-    mouse_event_listener_.reset();
+    for (const auto subscription : subscriptions_) {
+        InputBus::Get().Unsubscribe(subscription);
+    }
     camera_ = nullptr;
 }
\ No newline at end of file
@@ -3,25 +3,44 @@
 
 #pragma once
 
-#include "core/event_dispatcher.h"
+#include "core/event_bus.h"
 #include "core/orthographic_camera.h"
 
-#include <memory>
+#include <array>
 
 #include <glm/vec2.hpp>
 
+struct CameraMotion {
+    // viewport centre, world units per second
+    glm::vec2 pan {0.0f};
+    // log2 of the view scale per second, positive while zooming out
+    float zoom {0.0f};
+};
+
 class ZoomPanCamera {
 public:
     explicit ZoomPanCamera(OrthographicCamera* camera);
 
-    auto Update() -> void;
+    auto Update(double delta) -> void;
+
+    // Updates the velocity from the camera transform alone, for frames where
+    // something else moves the camera (e.g. a replay). Update() calls it.
+    auto TrackMotion(double delta) -> void;
+
+    // Smoothed over the last few frames, zero once the camera settles.
+    [[nodiscard]] auto Velocity() const { return velocity_; }
 
     ~ZoomPanCamera();
 
 private:
     OrthographicCamera* camera_;
 
-    std::shared_ptr<EventListener> mouse_event_listener_;
+    std::array<InputBus::Subscription, 3> subscriptions_ {};
+
+    CameraMotion velocity_ {};
+
+    glm::vec2 prev_center_ {0.0f};
+    float prev_scale_ {1.0f};
 
     glm::vec2 mouse_position_ {0.0f};
     glm::vec2 prev_position_ {0.0f};
@@ -5,9 +5,13 @@
 layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Normal;
 
+// per instance: xy is the tile centre, zw the tile size, the quad is 1x1
+layout (location = 3) in vec4 a_Transform;
+
 uniform mat4 u_Projection;
-uniform mat4 u_ModelView;
+uniform mat4 u_View;
 
 void main() {
-    gl_Position = u_Projection * u_ModelView * vec4(a_Position, 1.0);
+    vec2 position = a_Position.xy * a_Transform.zw + a_Transform.xy;
+    gl_Position = u_Projection * u_View * vec4(position, a_Position.z, 1.0);
 }
\ No newline at end of file
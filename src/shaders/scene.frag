@@ -5,9 +5,31 @@
 layout (location = 0) out vec4 FragColor;
 
 in vec2 v_TexCoord;
+flat in float v_Layer;
 
-uniform sampler2D u_TextureMap;
+// the planes of a JPEG tile, chroma at half the resolution of luma. Tiles
+// that aren't planar are all in u_Luma, swizzled to RGBA
+uniform sampler2DArray u_Luma;
+uniform sampler2DArray u_ChromaBlue;
+uniform sampler2DArray u_ChromaRed;
+uniform int u_Planar;
 
 void main() {
-    FragColor = texture(u_TextureMap, v_TexCoord);
+    vec3 coord = vec3(v_TexCoord, v_Layer);
+    if (u_Planar == 0) {
+        FragColor = texture(u_Luma, coord);
+        return;
+    }
+
+    float y = texture(u_Luma, coord).r;
+    float cb = texture(u_ChromaBlue, coord).r - 128.0 / 255.0;
+    float cr = texture(u_ChromaRed, coord).r - 128.0 / 255.0;
+
+    // JFIF's full range BT.601
+    FragColor = vec4(
+        y + 1.402 * cr,
+        y - 0.344136 * cb - 0.714136 * cr,
+        y + 1.772 * cb,
+        1.0
+    );
 }
\ No newline at end of file
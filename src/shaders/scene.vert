@@ -6,13 +6,24 @@ layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Normal;
 layout (location = 2) in vec2 a_TexCoord;
 
+// per instance: xy is the tile centre, zw the tile size, the quad is 1x1
+layout (location = 3) in vec4 a_Transform;
+// per instance: texture array layer holding the tile
+layout (location = 4) in float a_Layer;
+// per instance: xy offset, zw scale of the texture coordinates, a fallback
+// tile samples the part of its ancestor that covers it
+layout (location = 5) in vec4 a_TexRect;
+
 uniform mat4 u_Projection;
-uniform mat4 u_ModelView;
+uniform mat4 u_View;
 
 out vec2 v_TexCoord;
+flat out float v_Layer;
 
 void main() {
-    v_TexCoord = a_TexCoord;
+    v_TexCoord = a_TexRect.xy + a_TexCoord * a_TexRect.zw;
+    v_Layer = a_Layer;
 
-    gl_Position = u_Projection * u_ModelView * vec4(a_Position, 1.0);
+    vec2 position = a_Position.xy * a_Transform.zw + a_Transform.xy;
+    gl_Position = u_Projection * u_View * vec4(position, a_Position.z, 1.0);
 }
\ No newline at end of file
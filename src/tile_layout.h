@@ -0,0 +1,43 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+// On-disk layout of loose pyramid tiles, shared by the viewer and the
+// pyramid-build tool so both always agree on names.
+namespace tile_layout {
+    constexpr auto kTileSize = 512u;
+    constexpr auto kRoot = std::string_view {"assets"};
+    constexpr auto kName = std::string_view {"spiralcrop"};
+
+    // number of tiles along one axis of a LOD, a partial edge tile counts
+    // as a whole one (pyramid-build pads it out to kTileSize)
+    constexpr auto GridSize(unsigned int base_size, unsigned int lod) {
+        return ((base_size >> lod) + kTileSize - 1) / kTileSize;
+    }
+
+    // lod, y and x packed into 64 bits, unique across the pyramid
+    constexpr auto TileKey(unsigned int lod, unsigned int x, unsigned int y) -> std::uint64_t {
+        return (static_cast<std::uint64_t>(lod) << 56) |
+               (static_cast<std::uint64_t>(y) << 28) |
+                static_cast<std::uint64_t>(x);
+    }
+
+    // index is 1-based and row-major within the LOD grid
+    inline auto TilePath(
+        unsigned int lod,
+        unsigned int index,
+        const fs::path& root = kRoot,
+        std::string_view name = kName
+    ) -> fs::path {
+        return root / std::format("lod_{}", lod) / std::format("{}{}_{:02}.jpg", name, lod, index);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "tile_renderer.h"
+
+auto TileRenderer::BuildInstances(std::span<const TileDraw> tiles) -> void {
+    instances_.clear();
+    for (const auto& tile : tiles) {
+        const auto center = tile.position + tile.size / 2.0f;
+        instances_.emplace_back(RenderBackend::Instance {
+            .transform = {center.x, center.y, tile.size.x, tile.size.y},
+            .uv = tile.uv,
+            .layer = static_cast<float>(tile.chunk->Layer())
+        });
+    }
+}
+
+auto TileRenderer::Draw(std::span<const TileDraw> tiles, const OrthographicCamera& camera) -> void {
+    if (tiles.empty()) return;
+    BuildInstances(tiles);
+    backend_.DrawTiles(instances_, camera.Projection(), camera.View());
+}
+
+auto TileRenderer::DrawWireframes(std::span<const TileDraw> tiles, const OrthographicCamera& camera) -> void {
+    if (tiles.empty()) return;
+    BuildInstances(tiles);
+    backend_.DrawWireframes(instances_, camera.Projection(), camera.View());
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "chunk.h"
+
+#include "core/orthographic_camera.h"
+#include "core/render_backend.h"
+
+#include <span>
+#include <vector>
+
+// Draws tiles as instances of a single quad. Per-tile data goes into one
+// instance buffer that is uploaded once per frame, tiles sample their layer
+// of the shared texture array so the whole set is a single instanced draw.
+class TileRenderer {
+public:
+    explicit TileRenderer(RenderBackend& backend) : backend_(backend) {}
+
+    // Every chunk drawn must be resident in the texture array.
+    auto Draw(std::span<const TileDraw> tiles, const OrthographicCamera& camera) -> void;
+
+    // Outlines the footprints of the tiles.
+    auto DrawWireframes(std::span<const TileDraw> tiles, const OrthographicCamera& camera) -> void;
+
+private:
+    RenderBackend& backend_;
+
+    std::vector<RenderBackend::Instance> instances_ {};
+
+    auto BuildInstances(std::span<const TileDraw> tiles) -> void;
+};
\ No newline at end of file
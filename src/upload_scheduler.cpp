@@ -0,0 +1,38 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "upload_scheduler.h"
+
+#include "core/timer.h"
+
+#include <algorithm>
+
+auto UploadScheduler::Enqueue(Chunk* chunk, const TaskPriority& priority) -> void {
+    queue_.emplace_back(Entry {chunk, priority});
+}
+
+auto UploadScheduler::Run(const UploadCallback& upload) -> void {
+    std::ranges::sort(queue_, {}, &Entry::priority);
+
+    stats_ = {.pending = queue_.size()};
+    const auto timer = Timer {};
+
+    for (const auto& entry : queue_) {
+        // the first upload always runs so a large tile can't stall the queue
+        if (stats_.uploaded > 0) {
+            if (stats_.uploaded >= static_cast<std::size_t>(params.queue_depth)) break;
+            if (stats_.uploaded_bytes >= params.byte_budget) break;
+            if (timer.GetSeconds() * 1000.0 >= params.time_budget_ms) break;
+        }
+
+        const auto bytes = entry.chunk->Bytes();
+        if (!upload(entry.chunk)) break;
+
+        stats_.uploaded++;
+        stats_.uploaded_bytes += bytes;
+    }
+
+    stats_.pending -= stats_.uploaded;
+    stats_.upload_ms = timer.GetSeconds() * 1000.0;
+    queue_.clear();
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "chunk.h"
+
+#include "core/thread_pool.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Spreads texture uploads over frames. Loaded chunks are queued every frame
+// with a priority, the most important ones are uploaded until the frame's
+// time or byte budget runs out and the rest carry over to the next frame.
+class UploadScheduler {
+public:
+    struct Parameters {
+        float time_budget_ms {2.0f};
+        std::size_t byte_budget {8u << 20};
+        // the most uploads taken from the queue in one frame
+        int queue_depth {16};
+    };
+
+    struct Stats {
+        std::size_t pending {0};
+        std::size_t uploaded {0};
+        std::size_t uploaded_bytes {0};
+        double upload_ms {0.0};
+    };
+
+    // Returns false when the upload cannot happen this frame (e.g. no free
+    // texture layer), which ends the frame's uploads.
+    using UploadCallback = std::function<bool(Chunk*)>;
+
+    Parameters params;
+
+    explicit UploadScheduler(const Parameters& params) : params(params) {}
+
+    auto Enqueue(Chunk* chunk, const TaskPriority& priority) -> void;
+
+    // Uploads queued chunks in priority order within the budget, then clears
+    // the queue. Chunks left over are queued again by the next frame.
+    auto Run(const UploadCallback& upload) -> void;
+
+    [[nodiscard]] auto GetStats() const { return stats_; }
+
+private:
+    struct Entry {
+        Chunk* chunk;
+        TaskPriority priority;
+    };
+
+    std::vector<Entry> queue_ {};
+
+    Stats stats_ {};
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "downsample.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PYRAMID_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define PYRAMID_NEON
+    #include <arm_neon.h>
+#endif
+
+static auto DownsampleScalar(
+    const std::uint8_t* row0,
+    const std::uint8_t* row1,
+    std::uint8_t* out,
+    std::size_t out_width
+) -> void {
+    for (auto x = std::size_t {0}; x < out_width; ++x) {
+        const auto* a = row0 + x * 8;
+        const auto* b = row1 + x * 8;
+        for (auto c = 0; c < 4; ++c) {
+            const auto sum = a[c] + a[c + 4] + b[c] + b[c + 4];
+            out[x * 4 + c] = static_cast<std::uint8_t>((sum + 2) >> 2);
+        }
+    }
+}
+
+#ifdef PYRAMID_SSE2
+// 8 source pixels from each row in, 4 pixels out
+static auto Downsample4(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* out) {
+    const auto zero = _mm_setzero_si128();
+    const auto round = _mm_set1_epi16(2);
+
+    auto half = [&](const std::uint8_t* a, const std::uint8_t* b) {
+        const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        // vertical sums of pixels 0,1 and 2,3 widened to 16 bits
+        const auto v01 = _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+        const auto v23 = _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+        // horizontal sums (0 + 1) and (2 + 3)
+        const auto sum = _mm_add_epi16(_mm_unpacklo_epi64(v01, v23), _mm_unpackhi_epi64(v01, v23));
+        return _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+    };
+
+    const auto lo = half(row0, row1);
+    const auto hi = half(row0 + 16, row1 + 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(lo, hi));
+}
+#endif
+
+#ifdef PYRAMID_NEON
+// 16 source pixels from each row in, 8 pixels out
+static auto Downsample8(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* out) {
+    const auto a = vld4q_u8(row0);
+    const auto b = vld4q_u8(row1);
+    auto result = uint8x8x4_t {};
+    for (auto c = 0; c < 4; ++c) {
+        const auto sum = vaddq_u16(vpaddlq_u8(a.val[c]), vpaddlq_u8(b.val[c]));
+        result.val[c] = vrshrn_n_u16(sum, 2);
+    }
+    vst4_u8(out, result);
+}
+#endif
+
+auto DownsampleRows(
+    const std::uint8_t* row0,
+    const std::uint8_t* row1,
+    std::uint8_t* out,
+    std::size_t in_width
+) -> void {
+    const auto out_width = in_width / 2;
+    auto x = std::size_t {0};
+
+#if defined(PYRAMID_SSE2)
+    for (; x + 4 <= out_width; x += 4) {
+        Downsample4(row0 + x * 8, row1 + x * 8, out + x * 4);
+    }
+#elif defined(PYRAMID_NEON)
+    for (; x + 8 <= out_width; x += 8) {
+        Downsample8(row0 + x * 8, row1 + x * 8, out + x * 4);
+    }
+#endif
+
+    DownsampleScalar(row0 + x * 8, row1 + x * 8, out + x * 4, out_width - x);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 2x2 box filter over two RGBA rows: out[x] = round(avg of the four texels
+// under it). in_width is in pixels; a trailing odd column is dropped.
+auto DownsampleRows(
+    const std::uint8_t* row0,
+    const std::uint8_t* row1,
+    std::uint8_t* out,
+    std::size_t in_width
+) -> void;
\ No newline at end of file
@@ -0,0 +1,142 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "jpeg_io.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+
+#include <jpeglib.h>
+
+// libjpeg reports fatal errors through error_exit, which must not return.
+// Every function that calls into libjpeg sets the jump target first and
+// keeps no objects with destructors alive across the calls.
+struct ErrorManager {
+    jpeg_error_mgr manager;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+static auto ErrorExit(j_common_ptr info) -> void {
+    auto errors = reinterpret_cast<ErrorManager*>(info->err);
+    (*info->err->format_message)(info, errors->message);
+    std::longjmp(errors->jump, 1);
+}
+
+struct JpegReader::State {
+    jpeg_decompress_struct info {};
+    ErrorManager errors {};
+    std::FILE* file {nullptr};
+    bool started {false};
+};
+
+JpegReader::JpegReader() : state_(std::make_unique<State>()) {}
+
+auto JpegReader::Open(const fs::path& path) -> std::expected<std::unique_ptr<JpegReader>, std::string> {
+    auto reader = std::unique_ptr<JpegReader>(new JpegReader());
+    auto state = reader->state_.get();
+
+    state->file = std::fopen(path.string().c_str(), "rb");
+    if (state->file == nullptr) {
+        return std::unexpected(std::format("Failed to open '{}'", path.string()));
+    }
+
+    state->info.err = jpeg_std_error(&state->errors.manager);
+    state->errors.manager.error_exit = ErrorExit;
+    jpeg_create_decompress(&state->info);
+
+    if (setjmp(state->errors.jump)) {
+        return std::unexpected(std::string {state->errors.message});
+    }
+
+    jpeg_stdio_src(&state->info, state->file);
+    jpeg_read_header(&state->info, TRUE);
+    state->info.out_color_space = JCS_EXT_RGBA;
+    jpeg_start_decompress(&state->info);
+    state->started = true;
+
+    return reader;
+}
+
+auto JpegReader::Width() const -> unsigned int {
+    return state_->info.output_width;
+}
+
+auto JpegReader::Height() const -> unsigned int {
+    return state_->info.output_height;
+}
+
+auto JpegReader::ReadRows(std::uint8_t* out, unsigned int count) -> std::expected<unsigned int, std::string> {
+    auto& info = state_->info;
+    const auto stride = static_cast<std::size_t>(info.output_width) * 4;
+
+    if (setjmp(state_->errors.jump)) {
+        return std::unexpected(std::string {state_->errors.message});
+    }
+
+    auto rows = 0u;
+    while (rows < count && info.output_scanline < info.output_height) {
+        JSAMPROW row = out + rows * stride;
+        rows += jpeg_read_scanlines(&info, &row, 1);
+    }
+    return rows;
+}
+
+JpegReader::~JpegReader() {
+    if (setjmp(state_->errors.jump) == 0) {
+        if (state_->started) {
+            jpeg_abort_decompress(&state_->info);
+        }
+    }
+    jpeg_destroy_decompress(&state_->info);
+    if (state_->file) {
+        std::fclose(state_->file);
+    }
+}
+
+auto EncodeJpeg(
+    const std::uint8_t* pixels,
+    unsigned int width,
+    unsigned int height,
+    std::size_t stride,
+    int quality
+) -> std::expected<std::vector<unsigned char>, std::string> {
+    auto info = jpeg_compress_struct {};
+    auto errors = ErrorManager {};
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+
+    info.err = jpeg_std_error(&errors.manager);
+    errors.manager.error_exit = ErrorExit;
+
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_compress(&info);
+        std::free(buffer);
+        return std::unexpected(std::string {errors.message});
+    }
+
+    jpeg_create_compress(&info);
+    jpeg_mem_dest(&info, &buffer, &size);
+
+    info.image_width = width;
+    info.image_height = height;
+    info.input_components = 4;
+    info.in_color_space = JCS_EXT_RGBA;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, quality, TRUE);
+    jpeg_start_compress(&info, TRUE);
+
+    while (info.next_scanline < info.image_height) {
+        auto row = const_cast<JSAMPROW>(pixels + info.next_scanline * stride);
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+
+    auto result = std::vector<unsigned char>(buffer, buffer + size);
+    std::free(buffer);
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Streams a JPEG top to bottom as RGBA rows, so only the rows the caller
+// asks for are ever held in memory.
+class JpegReader {
+public:
+    [[nodiscard]] static auto Open(const fs::path& path) -> std::expected<std::unique_ptr<JpegReader>, std::string>;
+
+    [[nodiscard]] auto Width() const -> unsigned int;
+
+    [[nodiscard]] auto Height() const -> unsigned int;
+
+    // Reads up to count rows into out (Width() * 4 bytes per row) and returns
+    // the number of rows read, 0 once the image is exhausted.
+    auto ReadRows(std::uint8_t* out, unsigned int count) -> std::expected<unsigned int, std::string>;
+
+    ~JpegReader();
+
+private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+
+    JpegReader();
+};
+
+// Encodes an RGBA image, stride is the distance between rows in bytes.
+[[nodiscard]] auto EncodeJpeg(
+    const std::uint8_t* pixels,
+    unsigned int width,
+    unsigned int height,
+    std::size_t stride,
+    int quality
+) -> std::expected<std::vector<unsigned char>, std::string>;
\ No newline at end of file
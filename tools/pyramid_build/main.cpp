@@ -0,0 +1,304 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+// pyramid-build: cuts a source JPEG into the LOD tiles the viewer loads.
+//
+// The source is streamed in strips, each LOD keeps a single strip of
+// kTileSize rows, and every second row of a LOD is box-filtered into the
+// next one. Peak memory is about two strips of the source width, no matter
+// how tall the image is, except for progressive sources: libjpeg buffers
+// the whole coefficient image of those before the first row comes out.
+// Tiles of a strip are encoded in parallel. Edge tiles are padded out to
+// kTileSize by repeating the last column and row of the image.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "downsample.h"
+#include "jpeg_io.h"
+
+#include "loaders/tile_pack.h"
+#include "tile_layout.h"
+
+namespace fs = std::filesystem;
+
+using tile_layout::kTileSize;
+
+struct Options {
+    fs::path source {};
+    fs::path output {tile_layout::kRoot};
+    std::string name {tile_layout::kName};
+    fs::path pack {};
+    int quality {90};
+    unsigned int threads {std::max(std::thread::hardware_concurrency(), 1u)};
+};
+
+struct Level {
+    unsigned int lod {0};
+    unsigned int width {0};
+    unsigned int padded {0};
+    unsigned int grid_x {0};
+    unsigned int grid_y {0};
+    unsigned int tile_row {0};
+    unsigned int rows {0};
+    std::vector<std::uint8_t> strip {};
+
+    [[nodiscard]] auto Row(unsigned int row) {
+        return strip.data() + static_cast<std::size_t>(row) * padded * 4;
+    }
+};
+
+class PyramidBuilder {
+public:
+    PyramidBuilder(const Options& options, unsigned int width, unsigned int height) : options_(options) {
+        // halve until the whole level fits in a single tile
+        for (auto lod = 0u; (width >> lod) > 0 && (height >> lod) > 0; ++lod) {
+            const auto grid_x = tile_layout::GridSize(width, lod);
+            const auto grid_y = tile_layout::GridSize(height, lod);
+            levels_.emplace_back(Level {
+                .lod = lod,
+                .width = width >> lod,
+                .padded = grid_x * kTileSize,
+                .grid_x = grid_x,
+                .grid_y = grid_y,
+                .strip = std::vector<std::uint8_t>(static_cast<std::size_t>(grid_x) * kTileSize * kTileSize * 4)
+            });
+            if (grid_x == 1 && grid_y == 1) break;
+        }
+
+        if (!options_.pack.empty()) {
+            auto grids = std::vector<TileGrid> {};
+            for (const auto& level : levels_) {
+                grids.emplace_back(level.grid_x, level.grid_y);
+            }
+            pack_ = std::make_unique<TilePackWriter>(options_.pack, kTileSize, grids);
+        }
+    }
+
+    [[nodiscard]] auto Lods() const { return static_cast<unsigned int>(levels_.size()); }
+
+    [[nodiscard]] auto TilesWritten() const { return tiles_written_; }
+
+    auto PushRow(unsigned int index, const std::uint8_t* row) -> bool {
+        auto& level = levels_[index];
+        std::copy_n(row, static_cast<std::size_t>(level.width) * 4, level.Row(level.rows));
+        return CommitRow(index);
+    }
+
+    // emit the partial bottom strip of every level, then close the pack
+    auto Finish() -> bool {
+        for (auto& level : levels_) {
+            if (level.rows == 0 || level.tile_row >= level.grid_y) continue;
+            const auto last = level.Row(level.rows - 1);
+            const auto stride = static_cast<std::size_t>(level.padded) * 4;
+            for (auto row = level.rows; row < kTileSize; ++row) {
+                std::copy_n(last, stride, level.Row(row));
+            }
+            if (!EmitTiles(level)) return false;
+            level.rows = 0;
+            level.tile_row++;
+        }
+        return pack_ == nullptr || pack_->Finish();
+    }
+
+private:
+    Options options_;
+
+    std::vector<Level> levels_ {};
+
+    std::unique_ptr<TilePackWriter> pack_ {nullptr};
+
+    unsigned int tiles_written_ {0};
+
+    // the next row of the level is in place, advance the level
+    auto CommitRow(unsigned int index) -> bool {
+        auto& level = levels_[index];
+        PadRow(level, level.Row(level.rows));
+        level.rows++;
+
+        if (level.rows % 2 == 0 && index + 1 < levels_.size()) {
+            // average the last two rows straight into the next strip
+            auto& next = levels_[index + 1];
+            DownsampleRows(level.Row(level.rows - 2), level.Row(level.rows - 1), next.Row(next.rows), level.width);
+            if (!CommitRow(index + 1)) return false;
+        }
+
+        if (level.rows == kTileSize) {
+            level.rows = 0;
+            if (level.tile_row < level.grid_y && !EmitTiles(level)) return false;
+            level.tile_row++;
+        }
+
+        return true;
+    }
+
+    // repeat the last pixel of the row out to the padded width
+    static auto PadRow(const Level& level, std::uint8_t* row) -> void {
+        const auto last = row + static_cast<std::size_t>(level.width - 1) * 4;
+        for (auto x = level.width; x < level.padded; ++x) {
+            std::copy_n(last, 4, row + static_cast<std::size_t>(x) * 4);
+        }
+    }
+
+    auto EmitTiles(Level& level) -> bool {
+        auto tiles = std::vector<std::expected<std::vector<unsigned char>, std::string>>(level.grid_x);
+        auto next = std::atomic<unsigned int> {0};
+        const auto stride = static_cast<std::size_t>(level.padded) * 4;
+
+        {
+            auto workers = std::vector<std::jthread> {};
+            const auto threads = std::min(options_.threads, level.grid_x);
+            for (auto i = 0u; i < threads; ++i) {
+                workers.emplace_back([&] {
+                    for (auto x = next++; x < level.grid_x; x = next++) {
+                        const auto pixels = level.strip.data() + static_cast<std::size_t>(x) * kTileSize * 4;
+                        tiles[x] = EncodeJpeg(pixels, kTileSize, kTileSize, stride, options_.quality);
+                        if (tiles[x] && pack_ == nullptr) {
+                            tiles[x] = WriteTile(level, x, tiles[x].value());
+                        }
+                    }
+                });
+            }
+        }
+
+        for (auto x = 0u; x < level.grid_x; ++x) {
+            if (!tiles[x]) {
+                std::print(stderr, "LOD {} tile {},{}: {}\n", level.lod, x, level.tile_row, tiles[x].error());
+                return false;
+            }
+            if (pack_ && !pack_->AddTile(level.lod, x, level.tile_row, tiles[x].value())) {
+                std::print(stderr, "Failed to write '{}'\n", options_.pack.string());
+                return false;
+            }
+        }
+
+        tiles_written_ += level.grid_x;
+        std::print("LOD {}: row {}/{}\n", level.lod, level.tile_row + 1, level.grid_y);
+        return true;
+    }
+
+    auto WriteTile(
+        const Level& level,
+        unsigned int x,
+        const std::vector<unsigned char>& bytes
+    ) const -> std::expected<std::vector<unsigned char>, std::string> {
+        const auto index = level.tile_row * level.grid_x + x + 1;
+        const auto path = tile_layout::TilePath(level.lod, index, options_.output, options_.name);
+        auto file = std::ofstream {path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            return std::unexpected(std::format("Failed to write '{}'", path.string()));
+        }
+        // written already, keep nothing around
+        return std::vector<unsigned char> {};
+    }
+};
+
+static auto PrintUsage() {
+    std::print(stderr,
+        "usage: pyramid-build <source.jpg> [options]\n"
+        "  -o, --output <dir>     tile root, default '{}'\n"
+        "  -n, --name <prefix>    tile name prefix, default '{}'\n"
+        "  -p, --pack <file>      write a single tile pack instead of loose tiles\n"
+        "  -q, --quality <1-100>  JPEG quality, default 90\n"
+        "  -j, --threads <n>      encoder threads, default all cores\n"
+        "memory stays at a few tile rows of the source width, except for\n"
+        "progressive JPEGs, which libjpeg decodes whole before the first row\n",
+        tile_layout::kRoot, tile_layout::kName
+    );
+}
+
+static auto ParseOptions(int argc, char** argv) -> std::optional<Options> {
+    auto options = Options {};
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view {argv[i]};
+        const auto has_value = i + 1 < argc;
+        if ((arg == "-o" || arg == "--output") && has_value) {
+            options.output = argv[++i];
+        } else if ((arg == "-n" || arg == "--name") && has_value) {
+            options.name = argv[++i];
+        } else if ((arg == "-p" || arg == "--pack") && has_value) {
+            options.pack = argv[++i];
+        } else if ((arg == "-q" || arg == "--quality") && has_value) {
+            options.quality = std::clamp(std::atoi(argv[++i]), 1, 100);
+        } else if ((arg == "-j" || arg == "--threads") && has_value) {
+            options.threads = std::max(std::atoi(argv[++i]), 1);
+        } else if (!arg.starts_with('-') && options.source.empty()) {
+            options.source = arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (options.source.empty()) return std::nullopt;
+    return options;
+}
+
+auto main(int argc, char** argv) -> int {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    auto reader = JpegReader::Open(options->source);
+    if (!reader) {
+        std::print(stderr, "{}\n", reader.error());
+        return EXIT_FAILURE;
+    }
+
+    const auto width = reader.value()->Width();
+    const auto height = reader.value()->Height();
+    auto builder = PyramidBuilder {*options, width, height};
+    if (builder.Lods() == 0) {
+        std::print(stderr, "Image {}x{} is empty\n", width, height);
+        return EXIT_FAILURE;
+    }
+
+    if (options->pack.empty()) {
+        for (auto lod = 0u; lod < builder.Lods(); ++lod) {
+            fs::create_directories(options->output / std::format("lod_{}", lod));
+        }
+    }
+
+    constexpr auto kBatchRows = 16u;
+    auto batch = std::vector<std::uint8_t>(static_cast<std::size_t>(width) * 4 * kBatchRows);
+    while (true) {
+        const auto rows = reader.value()->ReadRows(batch.data(), kBatchRows);
+        if (!rows) {
+            std::print(stderr, "{}\n", rows.error());
+            return EXIT_FAILURE;
+        }
+        if (rows.value() == 0) break;
+        for (auto row = 0u; row < rows.value(); ++row) {
+            if (!builder.PushRow(0, batch.data() + static_cast<std::size_t>(row) * width * 4)) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (!builder.Finish()) {
+        std::print(stderr, "Failed to finish '{}'\n", options->pack.string());
+        return EXIT_FAILURE;
+    }
+
+    std::print(
+        "Wrote {} tiles, image {}x{} with {} LODs\n",
+        builder.TilesWritten(), width, height, builder.Lods()
+    );
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file